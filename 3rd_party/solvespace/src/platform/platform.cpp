@@ -77,23 +77,27 @@ void DebugPrint(const char *fmt, ...) {
 // Temporary arena.
 //-----------------------------------------------------------------------------
 
-struct Chunk {
-    Chunk()
-    {
-        data.resize(4096, 0);
-        ptr = data.data();
-        endptr = ptr + data.size();
-    }
-    std::vector<uint8_t> data;
-    uint8_t *ptr = nullptr;
-    uint8_t *endptr = nullptr;
-};
+static thread_local TemporaryArena defaultArena;
+static thread_local TemporaryArena *currentArena = nullptr;
+
+static TemporaryArena &GetTemporaryArena()
+{
+    if(currentArena)
+        return *currentArena;
+    return defaultArena;
+}
 
-static std::list<Chunk> chunks;
-static Chunk *last_chunk = nullptr;
+TemporaryArena *SetTemporaryArena(TemporaryArena *arena)
+{
+    auto previous = currentArena;
+    currentArena = arena;
+    return previous;
+}
 
 void *AllocTemporary(size_t size)
 {
+    auto &chunks = GetTemporaryArena().chunks;
+    auto &last_chunk = GetTemporaryArena().last_chunk;
     if(!last_chunk) {
         last_chunk = &chunks.emplace_back();
     }
@@ -110,6 +114,8 @@ void *AllocTemporary(size_t size)
 
 void FreeAllTemporary()
 {
+    auto &chunks = GetTemporaryArena().chunks;
+    auto &last_chunk = GetTemporaryArena().last_chunk;
     size_t total_size = 0;
     for(auto &chunk:chunks) {
         total_size += chunk.data.size();
@@ -127,6 +133,31 @@ void FreeAllTemporary()
     last_chunk = &chunk;
 }
 
+TemporaryMark GetTemporaryMark()
+{
+    auto &chunks = GetTemporaryArena().chunks;
+    auto &last_chunk = GetTemporaryArena().last_chunk;
+    if(!last_chunk)
+        return {0, nullptr};
+    return {chunks.size(), last_chunk->ptr};
+}
+
+void FreeTemporaryAfter(const TemporaryMark &mark)
+{
+    auto &chunks = GetTemporaryArena().chunks;
+    auto &last_chunk = GetTemporaryArena().last_chunk;
+    while(chunks.size() > mark.chunks) {
+        chunks.pop_back();
+    }
+    if(chunks.size() == 0) {
+        last_chunk = nullptr;
+        return;
+    }
+    last_chunk = &chunks.back();
+    memset(mark.ptr, 0, last_chunk->ptr - mark.ptr);
+    last_chunk->ptr = mark.ptr;
+}
+
 }
 }
 
@@ -7,6 +7,10 @@
 #ifndef SOLVESPACE_PLATFORM_H
 #define SOLVESPACE_PLATFORM_H
 
+#include <cstdint>
+#include <list>
+#include <vector>
+
 namespace SolveSpace {
 namespace Platform {
 
@@ -81,6 +85,38 @@ void DebugPrint(const char *fmt, ...);
 void *AllocTemporary(size_t size);
 void FreeAllTemporary();
 
+// Each thread allocates temporaries from its own default arena, unless it
+// has been told to use a different one.
+struct TemporaryArena {
+    struct Chunk {
+        Chunk()
+        {
+            data.resize(4096, 0);
+            ptr = data.data();
+            endptr = ptr + data.size();
+        }
+        std::vector<uint8_t> data;
+        uint8_t *ptr = nullptr;
+        uint8_t *endptr = nullptr;
+    };
+
+    std::list<Chunk> chunks;
+    Chunk *last_chunk = nullptr;
+};
+
+// Makes the current thread use the given arena, or its default one if
+// arena is null. Returns the arena that has been used before.
+TemporaryArena *SetTemporaryArena(TemporaryArena *arena);
+
+// Allows freeing everything that has been allocated after a certain point
+// while keeping what has been allocated before.
+struct TemporaryMark {
+    size_t   chunks;
+    uint8_t *ptr;
+};
+TemporaryMark GetTemporaryMark();
+void FreeTemporaryAfter(const TemporaryMark &mark);
+
 } // namespace Platform
 } // namespace SolveSpace
 
@@ -273,6 +273,7 @@ public:
     void WriteEquationsExceptFor(hConstraint hc, Group *g);
     void FindWhichToRemoveToFixJacobian(Group *g, List<hConstraint> *bad,
                                         bool forceDofCheck);
+    void FindRedundantConstraints(Group *g, List<hConstraint> *bad);
     void SolveBySubstitution();
 
     bool IsDragged(hParam p);
@@ -823,7 +824,11 @@ bool LinkIDF(const Platform::Path &filename, EntityList *le, SMesh *m, SShell *s
 bool LinkStl(const Platform::Path &filename, EntityList *le, SMesh *m, SShell *sh);
 
 extern SolveSpaceUI SS;
-extern Sketch SK;
+
+// The sketch everything operates on. Each thread can point it to a
+// different sketch so that independent solvers can run at the same time.
+extern thread_local Sketch *currentSketch;
+#define SK (*SolveSpace::currentSketch)
 
 }
 
@@ -12,6 +12,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/SparseQR>
+#include <Eigen/SVD>
 
 // The solver will converge all unknowns to within this tolerance. This must
 // always be much less than LENGTH_EPS, and in practice should be much less.
@@ -429,6 +430,71 @@ void System::FindWhichToRemoveToFixJacobian(Group *g, List<hConstraint> *bad, bo
     }
 }
 
+//-----------------------------------------------------------------------------
+// Find the same constraints as FindWhichToRemoveToFixJacobian, but from a
+// single decomposition of the Jacobian rather than one per constraint. The
+// system's equations that aren't generated from constraints (such as the
+// ones from groups) need to be in eq already.
+//-----------------------------------------------------------------------------
+void System::FindRedundantConstraints(Group *g, List<hConstraint> *bad) {
+    using namespace Eigen;
+    WriteEquationsExceptFor(Constraint::NO_CONSTRAINT, g);
+    param.ClearTags();
+    eq.ClearTags();
+
+    if(!WriteJacobian(0))
+        return;
+    EvalJacobian();
+    if(mat.m == 0)
+        return;
+
+    int rank = 0;
+    MatrixXd nullspace;
+    if(mat.n == 0) {
+        nullspace = MatrixXd::Identity(mat.m, mat.m);
+    } else {
+        SparseQR<SparseMatrix<double>, COLAMDOrdering<int>> solver;
+        solver.compute(mat.A.num);
+        rank = solver.rank();
+        if(rank == mat.m)
+            return;
+        // The columns of Q past the rank are an orthonormal basis of the
+        // Jacobian's left null space, i.e. of the combinations of equations
+        // that are linearly dependent.
+        MatrixXd select = MatrixXd::Zero(mat.m, mat.m - rank);
+        for(int i = 0; i < mat.m - rank; i++) {
+            select(rank + i, i) = 1;
+        }
+        nullspace = solver.matrixQ() * select;
+    }
+    const int nullity = mat.m - rank;
+
+    std::map<uint32_t, std::vector<int>> rowsByConstraint;
+    for(int i = 0; i < mat.m; i++) {
+        const hEquation h = mat.eq[i]->h;
+        if(h.isFromConstraint())
+            rowsByConstraint[h.constraint().v].push_back(i);
+    }
+
+    // Removing a constraint's equations makes the remaining ones independent
+    // if and only if every dependency involves them, that is if the null space
+    // restricted to their rows still has full rank.
+    for(const auto &[hcv, rows] : rowsByConstraint) {
+        if((int)rows.size() < nullity)
+            continue;
+        MatrixXd sub(rows.size(), nullity);
+        for(size_t i = 0; i < rows.size(); i++) {
+            sub.row(i) = nullspace.row(rows[i]);
+        }
+        JacobiSVD<MatrixXd> svd(sub);
+        const auto &sv = svd.singularValues();
+        if(sv(nullity - 1) > 1e-10) {
+            hConstraint hc = {hcv};
+            bad->Add(&hc);
+        }
+    }
+}
+
 struct Rearraged {
     Expr *lhs = nullptr;
     Expr *rhs = nullptr;
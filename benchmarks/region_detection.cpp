@@ -0,0 +1,66 @@
+// Measures how long finding the regions of a sketch takes depending on how
+// many segments its circles get approximated with. Run without arguments.
+
+#include "document/document.hpp"
+#include "document/solid_model_util.hpp"
+#include "document/entity/entity_circle2d.hpp"
+#include "document/group/group_reference.hpp"
+#include "util/uuid.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+
+using namespace dune3d;
+
+// overlapping circles, so that there are plenty of regions to find
+static constexpr unsigned int s_grid_size = 12;
+static constexpr unsigned int s_n_runs = 5;
+
+static void run(double radius)
+{
+    Document doc;
+    const auto groups = doc.get_groups_sorted();
+    const auto &reference = dynamic_cast<const GroupReference &>(*groups.front());
+    const auto wrkpl = reference.get_workplane_xy_uuid();
+    const auto sketch = groups.back()->m_uuid;
+
+    for (unsigned int x = 0; x < s_grid_size; x++) {
+        for (unsigned int y = 0; y < s_grid_size; y++) {
+            auto &circle = doc.add_entity<EntityCircle2D>(UUID::random());
+            circle.m_group = sketch;
+            circle.m_wrkpl = wrkpl;
+            circle.m_radius = radius;
+            circle.m_center = glm::dvec2(x, y) * radius * 1.5;
+        }
+    }
+    doc.set_group_generate_pending(sketch);
+    doc.update_pending();
+
+    using Duration = std::chrono::duration<double, std::milli>;
+    auto best = Duration::max();
+    unsigned int n_faces = 0;
+    for (unsigned int i = 0; i < s_n_runs; i++) {
+        const auto t_start = std::chrono::steady_clock::now();
+        const auto faces = solid_model_util::FaceBuilder::from_document(doc, wrkpl, sketch, glm::dvec3(0));
+        const Duration dt = std::chrono::steady_clock::now() - t_start;
+        best = std::min(best, dt);
+        n_faces = faces.get_n_faces();
+    }
+
+    const auto segments = solid_model_util::get_n_segments(radius, 2 * M_PI, 8);
+    std::cout << std::format("{:>10} {:>10} {:>10} {:>10} {:>10.2f}", radius, segments,
+                             segments * s_grid_size * s_grid_size, n_faces, best.count())
+              << std::endl;
+}
+
+int main()
+{
+    std::cout << std::format("{:>10} {:>10} {:>10} {:>10} {:>10}", "radius", "segments", "total", "faces", "ms")
+              << std::endl;
+    for (const double radius : {.05, .2, 1., 5., 25., 100., 500.}) {
+        run(radius);
+    }
+    return 0;
+}
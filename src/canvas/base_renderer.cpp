@@ -12,6 +12,8 @@ BaseRenderer::BaseRenderer(Canvas &c, ICanvas::VertexType vertex_type) : m_ca(c)
 
 void BaseRenderer::realize_base()
 {
+    m_pushed_sizes.clear();
+
     glGenBuffers(1, &m_ubo);
     glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
 
@@ -23,6 +25,8 @@ void BaseRenderer::realize_base()
     GET_LOC(this, view);
     GET_LOC(this, proj);
     GET_LOC(this, pick_base);
+    GET_LOC(this, pick_count);
+    GET_LOC(this, pick_flags);
 }
 
 
@@ -105,9 +109,10 @@ void BaseRenderer::load_uniforms()
 
     glUniformMatrix4fv(m_view_loc, 1, GL_FALSE, glm::value_ptr(m_ca.m_viewmat));
     glUniformMatrix4fv(m_proj_loc, 1, GL_FALSE, glm::value_ptr(m_ca.m_projmat));
-    glUniform1ui(m_pick_base_loc, m_ca.m_pick_base);
-    m_ca.m_vertex_type_picks[m_vertex_type] = {.offset = m_ca.m_pick_base, .count = get_vertex_count()};
-    m_ca.m_pick_base += get_vertex_count();
+    const auto &picks = m_ca.m_vertex_type_picks.at(m_vertex_type);
+    glUniform1ui(m_pick_base_loc, picks.offset);
+    glUniform1ui(m_pick_count_loc, picks.count);
+    glUniform1i(m_pick_flags_loc, Canvas::s_pick_flags_texture_unit);
 
     {
         UBOBuffer buf;
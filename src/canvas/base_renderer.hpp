@@ -7,9 +7,13 @@ class BaseRenderer {
 public:
     BaseRenderer(class Canvas &c, ICanvas::VertexType vertex_type);
     void set_peeled_picks(const std::vector<unsigned int> &peeled_picks);
+    virtual size_t get_vertex_count() const = 0;
+    ICanvas::VertexType get_vertex_type() const
+    {
+        return m_vertex_type;
+    }
 
 protected:
-    virtual size_t get_vertex_count() const = 0;
     void realize_base();
 
     Canvas &m_ca;
@@ -18,11 +22,16 @@ protected:
     void load_uniforms();
     std::vector<unsigned int> m_peeled_picks;
 
+    // sizes of the arrays in the vertex buffer, see push_buffer_parts
+    std::vector<size_t> m_pushed_sizes;
+
     GLuint m_program;
     GLuint m_ubo;
 
     GLuint m_view_loc;
     GLuint m_proj_loc;
     GLuint m_pick_base_loc;
+    GLuint m_pick_count_loc;
+    GLuint m_pick_flags_loc;
 };
 } // namespace dune3d
@@ -14,6 +14,8 @@
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtx/io.hpp>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 #include "iselection_menu_creator.hpp"
 #include "selectable_checkbutton.hpp"
 
@@ -46,6 +48,7 @@ Canvas::Canvas()
     m_all_renderers.push_back(&m_glyph_renderer);
     m_all_renderers.push_back(&m_glyph_3d_renderer);
     m_all_renderers.push_back(&m_icon_renderer);
+    m_lod_generator.signal_done().connect([this] { queue_draw(); });
     set_can_focus(true);
     set_focusable(true);
 
@@ -335,12 +338,13 @@ void Canvas::update_drag_selection(glm::vec2 pos)
     const auto y0 = static_cast<int>(a.y);
     const auto x1 = static_cast<int>(b.x);
     const auto y1 = static_cast<int>(b.y);
+    fetch_pick_region(x0, y0, x1, y1);
     std::set<int> picks;
     std::set<int> picks_border;
     for (int x = x0; x <= x1; x++) {
         for (int y = y0; y <= y1; y++) {
             const bool is_border = (x == x0) || (x == x1) || (y == y0) || (y == y1);
-            const auto pick = read_pick_buf(m_pick_buf, x, y);
+            const auto pick = read_pick_buf(m_pick_region, x, y);
             if (pick) {
                 if (is_border)
                     picks_border.insert(pick);
@@ -566,31 +570,79 @@ std::optional<SelectableRef> Canvas::get_selectable_ref_for_pick(unsigned int pi
 
 void Canvas::clear_flags(VertexFlags mask)
 {
-    for (auto &x : m_lines) {
-        x.flags &= ~mask;
-    }
-    for (auto &x : m_points) {
-        x.flags &= ~mask;
-    }
-    for (auto &x : m_glyphs) {
-        x.flags &= ~mask;
+    if ((mask & VertexFlags::SELECTED) != VertexFlags::DEFAULT)
+        m_selection.clear();
+    const auto m = static_cast<uint8_t>(mask);
+    for (auto &[type, pick_flags] : m_pick_flags) {
+        for (size_t i = 0; i < pick_flags.flags.size(); i++) {
+            auto &flags = pick_flags.flags[i];
+            if (flags & m) {
+                flags &= ~m;
+                pick_flags.dirty.add(i);
+            }
+        }
     }
-    for (auto &x : m_glyphs_3d) {
-        x.flags &= ~mask;
+}
+
+Canvas::VertexFlags Canvas::get_pick_flags(const VertexRef &vref) const
+{
+    auto it = m_pick_flags.find(vref.type);
+    if (it == m_pick_flags.end() || vref.index >= it->second.flags.size())
+        return VertexFlags::DEFAULT;
+    return static_cast<VertexFlags>(it->second.flags[vref.index]);
+}
+
+void Canvas::set_pick_flags(const VertexRef &vref, VertexFlags flags)
+{
+    auto &pick_flags = m_pick_flags[vref.type];
+    if (vref.index >= pick_flags.flags.size())
+        pick_flags.flags.resize(vref.index + 1, 0);
+    auto &vflags = pick_flags.flags[vref.index];
+    const uint8_t new_flags = vflags | static_cast<uint8_t>(flags);
+    if (new_flags == vflags)
+        return;
+    vflags = new_flags;
+    pick_flags.dirty.add(vref.index);
+}
+
+void Canvas::update_vertex_type_picks()
+{
+    // pick 0 is the background, the renderers get consecutive picks in the order they're rendered in
+    m_vertex_type_picks.clear();
+    size_t offset = 1;
+    for (const auto renderer : m_all_renderers) {
+        const auto count = renderer->get_vertex_count();
+        m_vertex_type_picks[renderer->get_vertex_type()] = {.offset = offset, .count = count};
+        offset += count;
     }
-    for (auto &x : m_face_groups) {
-        x.flags &= ~mask;
+}
+
+void Canvas::push_pick_flags()
+{
+    std::vector<BufferPart<uint8_t>> parts;
+    for (const auto renderer : m_all_renderers) {
+        const auto type = renderer->get_vertex_type();
+        auto &pick_flags = m_pick_flags[type];
+        pick_flags.flags.resize(m_vertex_type_picks.at(type).count, 0);
+        parts.push_back({pick_flags.flags, pick_flags.dirty});
     }
-    for (auto &x : m_icons) {
-        x.flags &= ~mask;
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pick_flags_buffer);
+    push_buffer_parts<uint8_t>(GL_TEXTURE_BUFFER, m_pushed_pick_flags_sizes, parts);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    for (auto &[type, pick_flags] : m_pick_flags) {
+        pick_flags.dirty.reset();
     }
+
+    glActiveTexture(GL_TEXTURE0 + s_pick_flags_texture_unit);
+    glBindTexture(GL_TEXTURE_BUFFER, m_pick_flags_texture);
+    glActiveTexture(GL_TEXTURE0);
 }
 
-unsigned int Canvas::get_hover_pick(const std::vector<pick_buf_t> &pick_buf) const
+unsigned int Canvas::get_hover_pick(const PickRegion &region) const
 {
-    auto pick = read_pick_buf(pick_buf, m_last_x, m_last_y);
+    auto pick = read_pick_buf(region, m_last_x, m_last_y);
     if (!pick || get_vertex_ref_for_pick(pick).type == VertexType::FACE_GROUP) {
-        int box_size = 10;
+        int box_size = s_hover_box_size;
         float best_distance = glm::vec2(box_size, box_size).length();
         unsigned int best_pick = pick;
         for (int dx = -box_size; dx <= box_size; dx++) {
@@ -598,7 +650,7 @@ unsigned int Canvas::get_hover_pick(const std::vector<pick_buf_t> &pick_buf) con
                 int px = m_last_x + dx;
                 int py = m_last_y + dy;
                 if (px >= 0 && px < m_dev_width && py >= 0 && py < m_dev_height) {
-                    if (auto p = read_pick_buf(pick_buf, px, py)) {
+                    if (auto p = read_pick_buf(region, px, py)) {
                         if (get_vertex_ref_for_pick(p).type == VertexType::FACE_GROUP)
                             continue;
                         const auto d = glm::vec2(dx, dy).length();
@@ -615,9 +667,11 @@ unsigned int Canvas::get_hover_pick(const std::vector<pick_buf_t> &pick_buf) con
     return pick;
 }
 
-unsigned int Canvas::get_hover_pick() const
+unsigned int Canvas::get_hover_pick()
 {
-    return get_hover_pick(m_pick_buf);
+    fetch_pick_region(m_last_x - s_hover_box_size, m_last_y - s_hover_box_size, m_last_x + s_hover_box_size,
+                      m_last_y + s_hover_box_size);
+    return get_hover_pick(m_pick_region);
 }
 
 
@@ -642,26 +696,137 @@ void Canvas::update_hover_selection()
             clear_flags(mask);
             if (m_hover_selection.has_value()) {
                 for (const auto &vref : m_selectable_to_vertex_map.at(m_hover_selection.value())) {
-                    auto &flags = get_vertex_flags(vref);
-                    flags |= mask;
+                    set_pick_flags(vref, mask);
                 }
+                if ((mask & VertexFlags::SELECTED) != VertexFlags::DEFAULT)
+                    m_selection.insert(m_hover_selection.value());
             }
-            m_push_flags =
-                    static_cast<PushFlags>(m_push_flags | PF_LINES | PF_POINTS | PF_GLYPHS | PF_GLYPHS_3D | PF_ICONS);
             queue_draw();
             m_signal_hover_selection_changed.emit();
         }
     }
 }
 
-Canvas::pick_buf_t Canvas::read_pick_buf(const std::vector<pick_buf_t> &pick_buf, int x, int y) const
+Canvas::pick_buf_t Canvas::read_pick_buf(const PickRegion &region, int x, int y) const
 {
     int xi = x * m_scale_factor;
     int yi = y * m_scale_factor;
     if (xi >= m_dev_width || yi >= m_dev_height || x < 0 || y < 0)
         return 0;
-    const int idx = ((m_dev_height)-yi - 1) * m_dev_width + xi;
-    return pick_buf.at(idx);
+    yi = m_dev_height - yi - 1;
+    if (!region.rect.contains({xi, yi, xi, yi}))
+        return 0;
+    const int idx = (yi - region.rect.y0) * region.rect.get_width() + (xi - region.rect.x0);
+    return region.data.at(idx);
+}
+
+Canvas::PickRect Canvas::get_pick_rect(int x0, int y0, int x1, int y1, int margin) const
+{
+    PickRect rect;
+    rect.x0 = std::max((x0 - margin) * m_scale_factor, 0);
+    rect.x1 = std::min((x1 + margin + 1) * m_scale_factor - 1, m_dev_width - 1);
+    rect.y0 = std::max(m_dev_height - (y1 + margin + 1) * m_scale_factor, 0);
+    rect.y1 = std::min(m_dev_height - 1 - (y0 - margin) * m_scale_factor, m_dev_height - 1);
+    return rect;
+}
+
+void Canvas::read_pick_region(PickRegion &region, const PickRect &rect)
+{
+    region.rect = rect;
+    region.data.resize(std::max(rect.get_width(), 0) * std::max(rect.get_height(), 0));
+    if (region.data.empty())
+        return;
+
+    GLint read_fb;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_fb);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_downsampled);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(rect.x0, rect.y0, rect.get_width(), rect.get_height(), GL_RED_INTEGER, GL_UNSIGNED_INT,
+                 region.data.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_fb);
+    GL_CHECK_ERROR
+}
+
+void Canvas::fetch_pick_region(int x0, int y0, int x1, int y1)
+{
+    const auto rect = get_pick_rect(x0, y0, x1, y1, 0);
+    if (rect.get_width() <= 0 || rect.get_height() <= 0)
+        return;
+    if (m_pick_region.rect.contains(rect))
+        return;
+
+    if (m_pick_fence && m_pick_pbo_rect.contains(rect)) {
+        finish_pick_readback();
+        return;
+    }
+
+    if (!m_pick_fb_current)
+        return;
+
+    // the cursor left the region that's been read back after rendering,
+    // read a bit more than needed to not end up here on every motion event
+    make_current();
+    discard_pick_readback();
+    read_pick_region(m_pick_region, get_pick_rect(x0, y0, x1, y1, s_pick_readback_margin));
+}
+
+void Canvas::start_pick_readback()
+{
+    discard_pick_readback();
+    m_pick_region.rect = {};
+    m_pick_fb_current = true;
+
+    const auto box_size = s_hover_box_size + s_pick_readback_margin;
+    const auto rect = get_pick_rect(m_last_x - box_size, m_last_y - box_size, m_last_x + box_size,
+                                    m_last_y + box_size, 0);
+    if (rect.get_width() <= 0 || rect.get_height() <= 0)
+        return;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_downsampled);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pick_pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, rect.get_width() * rect.get_height() * sizeof(pick_buf_t), nullptr,
+                 GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(rect.x0, rect.y0, rect.get_width(), rect.get_height(), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_pick_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_pick_pbo_rect = rect;
+    GL_CHECK_ERROR
+}
+
+void Canvas::finish_pick_readback()
+{
+    if (!m_pick_fence)
+        return;
+    make_current();
+    // usually done by now, since there's been at least one motion event since rendering
+    glClientWaitSync(m_pick_fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(m_pick_fence);
+    m_pick_fence = nullptr;
+
+    m_pick_region.rect = m_pick_pbo_rect;
+    m_pick_region.data.resize(m_pick_pbo_rect.get_width() * m_pick_pbo_rect.get_height());
+    const auto size = m_pick_region.data.size() * sizeof(pick_buf_t);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pick_pbo);
+    if (auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)) {
+        memcpy(m_pick_region.data.data(), data, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else {
+        m_pick_region.rect = {};
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    GL_CHECK_ERROR
+}
+
+void Canvas::discard_pick_readback()
+{
+    if (!m_pick_fence)
+        return;
+    glDeleteSync(m_pick_fence);
+    m_pick_fence = nullptr;
 }
 
 glm::dvec3 Canvas::get_cursor_pos_for_plane(glm::dvec3 origin, glm::dvec3 normal) const
@@ -736,6 +901,16 @@ void Canvas::on_realize()
     glGenRenderbuffers(1, &m_pickrenderbuffer_downsampled);
     glGenRenderbuffers(1, &m_last_frame_renderbuffer);
     glGenTextures(1, &m_selection_texture);
+    glGenBuffers(1, &m_pick_pbo);
+
+    glGenBuffers(1, &m_pick_flags_buffer);
+    glGenTextures(1, &m_pick_flags_texture);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_pick_flags_buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, m_pick_flags_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, m_pick_flags_buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    m_pushed_pick_flags_sizes.clear();
 
     resize_buffers();
 
@@ -822,6 +997,10 @@ void Canvas::resize_buffers()
 
     glBindRenderbuffer(GL_RENDERBUFFER, rb);
 
+    // pick buffer contents are undefined until the next frame has been rendered
+    discard_pick_readback();
+    m_pick_region.rect = {};
+    m_pick_fb_current = false;
 
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_selection_texture);
     GL_CHECK_ERROR
@@ -829,44 +1008,68 @@ void Canvas::resize_buffers()
     GL_CHECK_ERROR
 }
 
-ICanvas::VertexRef Canvas::add_face_group(const face::Faces &faces, glm::vec3 origin, glm::quat normal,
-                                          FaceColor face_color)
+ICanvas::VertexRef Canvas::add_face_group(std::shared_ptr<const face::Faces> faces, glm::vec3 origin,
+                                          glm::quat normal, FaceColor face_color)
 {
-    auto offset = m_face_index_buffer.size();
-    add_faces(faces);
-    auto length = m_face_index_buffer.size() - offset;
+    // the faces stay as they are, the transform gets applied in the shader
     m_face_groups.push_back(FaceGroup{
-            .offset = offset,
-            .length = length,
-            .origin = origin,
-            .normal = normal,
+            .faces = std::move(faces),
+            .origin = transform_point(origin),
+            .normal = glm::quat_cast(m_transform) * normal,
             .color = face_color,
     });
 
     return {VertexType::FACE_GROUP, m_face_groups.size() - 1};
 }
 
-void Canvas::add_faces(const face::Faces &faces)
+ICanvas::VertexRef Canvas::add_face_group(std::shared_ptr<const face::FacesLOD> faces, glm::vec3 origin,
+                                          glm::quat normal, FaceColor face_color)
 {
-    size_t vertex_offset = m_face_vertex_buffer.size();
-    for (const auto &face : faces) {
-        for (size_t i = 0; i < face.vertices.size(); i++) {
-            const auto &v = face.vertices.at(i);
-            const auto &n = face.normals.at(i);
-            auto vt = transform_point({v.x, v.y, v.z});
-            auto nt = transform_point_rel({n.x, n.y, n.z});
-            m_face_vertex_buffer.emplace_back(vt.x, vt.y, vt.z, nt.x, nt.y, nt.z, face.color.r * 255,
-                                              face.color.g * 255, face.color.b * 255);
-        }
+    // starts out with the base level, update_face_lods picks the one to draw
+    auto base = std::shared_ptr<const face::Faces>(faces, &faces->get_level(face::FacesLOD::s_base_level));
+    const auto vref = add_face_group(std::move(base), origin, normal, face_color);
+    m_face_groups.back().lod = std::move(faces);
+    return vref;
+}
 
-        for (const auto &tri : face.triangle_indices) {
-            size_t a, b, c;
-            std::tie(a, b, c) = tri;
-            m_face_index_buffer.push_back(a + vertex_offset);
-            m_face_index_buffer.push_back(b + vertex_offset);
-            m_face_index_buffer.push_back(c + vertex_offset);
+unsigned int Canvas::get_lod_level(const std::pair<glm::vec3, glm::vec3> &bbox) const
+{
+    const auto mvp = m_projmat * m_viewmat;
+    const auto &[a, b] = bbox;
+    // pixels per unit at the corner that's closest to the camera
+    float scale = 0;
+    for (const auto &corner : {glm::vec3(a.x, a.y, a.z), glm::vec3(a.x, a.y, b.z), glm::vec3(a.x, b.y, a.z),
+                               glm::vec3(a.x, b.y, b.z), glm::vec3(b.x, a.y, a.z), glm::vec3(b.x, a.y, b.z),
+                               glm::vec3(b.x, b.y, a.z), glm::vec3(b.x, b.y, b.z)}) {
+        const auto c = mvp * glm::vec4(corner, 1);
+        if (c.w <= 0)
+            return 0;
+        scale = std::max(scale, m_projmat[1][1] * m_dev_height / 2 / c.w);
+    }
+    for (unsigned int level = face::FacesLOD::s_n_levels - 1; level > 0; level--) {
+        if (face::FacesLOD::get_deflection(level) * scale <= s_lod_max_error)
+            return level;
+    }
+    return 0;
+}
+
+void Canvas::update_face_lods()
+{
+    for (auto &group : m_face_groups) {
+        if (!group.lod)
+            continue;
+        const auto bb = get_face_group_bbox(group);
+        if (!bb)
+            continue;
+        const auto level = get_lod_level(*bb);
+        if (group.lod->request_level(level))
+            m_lod_generator.submit(group.lod, level);
+        // draws the closest level that's available until the requested one has been created
+        const auto &faces = group.lod->get_level(level);
+        if (&faces != group.faces.get()) {
+            group.faces = std::shared_ptr<const face::Faces>(group.lod, &faces);
+            m_push_flags = static_cast<PushFlags>(m_push_flags | PF_FACES);
         }
-        vertex_offset += face.vertices.size();
     }
 }
 
@@ -912,7 +1115,7 @@ void Canvas::update_mats()
     m_projmat_viewmat_inv = glm::inverse(m_projmat * m_viewmat);
 }
 
-void Canvas::render_all(std::vector<pick_buf_t> &pick_buf)
+void Canvas::render_all()
 {
     glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
 
@@ -931,6 +1134,12 @@ void Canvas::render_all(std::vector<pick_buf_t> &pick_buf)
     glEnable(GL_DEPTH_TEST);
 
 
+    mark_dirty_since(m_unchunked_begin);
+    m_unchunked_begin = get_array_sizes();
+
+    update_mats();
+    update_face_lods();
+
     if (m_push_flags & PF_FACES)
         m_face_renderer.push();
     if (m_push_flags & PF_POINTS)
@@ -946,9 +1155,11 @@ void Canvas::render_all(std::vector<pick_buf_t> &pick_buf)
 
     m_push_flags = PF_NONE;
 
-    update_mats();
+    update_vertex_type_picks();
+    push_pick_flags();
+
+    update_culling();
 
-    m_pick_base = 1;
     m_face_renderer.render();
     GL_CHECK_ERROR
     // glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
@@ -987,28 +1198,36 @@ void Canvas::render_all(std::vector<pick_buf_t> &pick_buf)
     glBlitFramebuffer(0, 0, m_dev_width, m_dev_height, 0, 0, m_dev_width, m_dev_height, GL_COLOR_BUFFER_BIT,
                       GL_NEAREST);
 
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_downsampled);
-    glReadBuffer(GL_COLOR_ATTACHMENT0);
-    pick_buf.resize(m_dev_width * m_dev_height);
     GL_CHECK_ERROR
-
-    glPixelStorei(GL_PACK_ALIGNMENT, 4);
-    glReadPixels(0, 0, m_dev_width, m_dev_height, GL_RED_INTEGER, GL_UNSIGNED_INT, pick_buf.data());
 }
 
 void Canvas::peel_selection()
 {
-    std::vector<pick_buf_t> pick_buf;
+    // only the area around the cursor matters for peeling, so that's all
+    // that gets rasterized, cleared, resolved and read back in each pass
+    const auto hover_rect = get_pick_rect(m_last_x - s_hover_box_size, m_last_y - s_hover_box_size,
+                                          m_last_x + s_hover_box_size, m_last_y + s_hover_box_size, 0);
+    PickRegion region;
     std::vector<unsigned int> peeled_picks;
-    for (auto pick = get_hover_pick(m_pick_buf); pick; pick = get_hover_pick(pick_buf)) {
-        peeled_picks.push_back(pick);
-        if (peeled_picks.size() > s_peel_max) {
-            break;
-        }
-        for (auto renderer : m_all_renderers) {
-            renderer->set_peeled_picks(peeled_picks);
+    if (hover_rect.get_width() > 0 && hover_rect.get_height() > 0) {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(hover_rect.x0, hover_rect.y0, hover_rect.get_width(), hover_rect.get_height());
+        for (auto pick = get_hover_pick(); pick; pick = get_hover_pick(region)) {
+            peeled_picks.push_back(pick);
+            if (peeled_picks.size() > s_peel_max) {
+                break;
+            }
+            // nothing behind a face group ends up in the menu
+            if (get_vertex_ref_for_pick(pick).type == VertexType::FACE_GROUP)
+                break;
+            for (auto renderer : m_all_renderers) {
+                renderer->set_peeled_picks(peeled_picks);
+            }
+            render_all();
+            m_pick_fb_current = false;
+            read_pick_region(region, hover_rect);
         }
-        render_all(pick_buf);
+        glDisable(GL_SCISSOR_TEST);
     }
 
     ISelectionMenuCreator::SelectableRefAndVertexTypeList srv_list;
@@ -1124,17 +1343,20 @@ bool Canvas::on_render(const Glib::RefPtr<Gdk::GLContext> &context)
         for (auto renderer : m_all_renderers) {
             renderer->set_peeled_picks({});
         }
-        render_all(m_pick_buf);
+        render_all();
+        start_pick_readback();
     }
 
 
     GL_CHECK_ERROR
-    if (m_pick_state == PickState::QUEUED) {
+    if (m_pick_state == PickState::QUEUED && m_pick_fb_current) {
         m_pick_state = PickState::CURRENT;
+        PickRegion region;
+        read_pick_region(region, {0, 0, m_dev_width - 1, m_dev_height - 1});
         std::ofstream ofs(m_pick_path.string());
         for (int y = 0; y < m_dev_height; y++) {
             for (int x = 0; x < m_dev_width; x++) {
-                ofs << m_pick_buf.at(x + y * m_dev_width) << " ";
+                ofs << region.data.at(x + y * m_dev_width) << " ";
             }
             ofs << std::endl;
         }
@@ -1206,8 +1428,39 @@ void Canvas::queue_pick(const std::filesystem::path &pick_path)
 
 void Canvas::clear()
 {
-    m_face_index_buffer.clear();
-    m_face_vertex_buffer.clear();
+    // chunks are reused by copying them from the last frame, so the ones
+    // that haven't been drawn in the last frame are gone for good
+    std::erase_if(m_chunks, [this](const auto &it) { return it.second.frame != m_frame; });
+    m_frame++;
+    m_current_chunk = nullptr;
+    m_chunk_depth = 0;
+    m_unchunked_begin = {};
+
+    // if the last frame has been pushed, only what's different from it needs to be pushed
+    if (m_push_flags == PF_NONE)
+        m_dirty.reset();
+    else
+        m_dirty.set_all();
+
+    std::swap(m_last_frame.points, m_points);
+    std::swap(m_last_frame.points_selection_invisible, m_points_selection_invisible);
+    std::swap(m_last_frame.lines, m_lines);
+    std::swap(m_last_frame.lines_selection_invisible, m_lines_selection_invisible);
+    std::swap(m_last_frame.glyphs, m_glyphs);
+    std::swap(m_last_frame.glyphs_3d, m_glyphs_3d);
+    std::swap(m_last_frame.icons, m_icons);
+    std::swap(m_last_frame.icons_selection_invisible, m_icons_selection_invisible);
+    std::swap(m_last_frame.face_groups, m_face_groups);
+
+    // everything starts out unselected, the GPU still has the flags of the last frame
+    for (auto &[type, pick_flags] : m_pick_flags) {
+        for (size_t i = 0; i < pick_flags.flags.size(); i++) {
+            if (pick_flags.flags[i])
+                pick_flags.dirty.add(i);
+        }
+        pick_flags.flags.clear();
+    }
+
     m_face_groups.clear();
     m_points.clear();
     m_points_selection_invisible.clear();
@@ -1219,11 +1472,280 @@ void Canvas::clear()
     m_icons_selection_invisible.clear();
     m_selectable_to_vertex_map.clear();
     m_vertex_to_selectable_map.clear();
+    m_selection.clear();
     m_vertex_type_picks.clear();
     m_push_flags = PF_ALL;
     queue_draw();
 }
 
+size_t Canvas::ArraySizes::get(VertexType type) const
+{
+    switch (type) {
+    case VertexType::POINT:
+        return points;
+    case VertexType::LINE:
+        return lines;
+    case VertexType::GLYPH:
+        return glyphs;
+    case VertexType::GLYPH_3D:
+        return glyphs_3d;
+    case VertexType::ICON:
+        return icons;
+    case VertexType::FACE_GROUP:
+        return face_groups;
+    default:
+        return 0;
+    }
+}
+
+Canvas::ArraySizes Canvas::get_array_sizes() const
+{
+    return {
+            .points = m_points.size(),
+            .points_selection_invisible = m_points_selection_invisible.size(),
+            .lines = m_lines.size(),
+            .lines_selection_invisible = m_lines_selection_invisible.size(),
+            .glyphs = m_glyphs.size(),
+            .glyphs_3d = m_glyphs_3d.size(),
+            .icons = m_icons.size(),
+            .icons_selection_invisible = m_icons_selection_invisible.size(),
+            .face_groups = m_face_groups.size(),
+    };
+}
+
+void Canvas::DirtyArrays::set_all()
+{
+    for (auto dirty : {&points, &points_selection_invisible, &lines, &lines_selection_invisible, &glyphs, &glyphs_3d,
+                       &icons, &icons_selection_invisible}) {
+        dirty->set_all();
+    }
+}
+
+void Canvas::DirtyArrays::reset()
+{
+    for (auto dirty : {&points, &points_selection_invisible, &lines, &lines_selection_invisible, &glyphs, &glyphs_3d,
+                       &icons, &icons_selection_invisible}) {
+        dirty->reset();
+    }
+}
+
+void Canvas::mark_dirty_since(const ArraySizes &sizes)
+{
+    m_dirty.points.add(sizes.points, m_points.size());
+    m_dirty.points_selection_invisible.add(sizes.points_selection_invisible, m_points_selection_invisible.size());
+    m_dirty.lines.add(sizes.lines, m_lines.size());
+    m_dirty.lines_selection_invisible.add(sizes.lines_selection_invisible, m_lines_selection_invisible.size());
+    m_dirty.glyphs.add(sizes.glyphs, m_glyphs.size());
+    m_dirty.glyphs_3d.add(sizes.glyphs_3d, m_glyphs_3d.size());
+    m_dirty.icons.add(sizes.icons, m_icons.size());
+    m_dirty.icons_selection_invisible.add(sizes.icons_selection_invisible, m_icons_selection_invisible.size());
+}
+
+bool Canvas::begin_chunk(const UUID &key)
+{
+    // nested chunks are part of the outer one
+    if (m_chunk_depth++)
+        return true;
+
+    mark_dirty_since(m_unchunked_begin);
+    m_unchunked_begin = get_array_sizes();
+
+    auto it = m_chunks.find(key);
+    if (it != m_chunks.end() && it->second.frame == m_frame - 1) {
+        reuse_chunk(it->second);
+        m_chunk_depth--;
+        m_unchunked_begin = get_array_sizes();
+        return false;
+    }
+
+    // the same key twice in one frame, the first one wins
+    if (it != m_chunks.end())
+        return true;
+
+    auto &chunk = m_chunks[key];
+    chunk.begin = m_unchunked_begin;
+    chunk.frame = m_frame;
+    m_current_chunk = &chunk;
+    return true;
+}
+
+void Canvas::end_chunk()
+{
+    if (--m_chunk_depth)
+        return;
+
+    if (m_current_chunk) {
+        m_current_chunk->end = get_array_sizes();
+        m_current_chunk->bbox = get_chunk_bbox(*m_current_chunk);
+        m_current_chunk = nullptr;
+    }
+    mark_dirty_since(m_unchunked_begin);
+    m_unchunked_begin = get_array_sizes();
+}
+
+void Canvas::reuse_chunk(Chunk &chunk)
+{
+    const auto begin = get_array_sizes();
+
+    // vertices that end up where they've been in the last frame are already on the GPU
+    auto reuse = [](auto &vertices, const auto &last_vertices, size_t first, size_t last, DirtyRanges &dirty) {
+        const auto offset = vertices.size();
+        vertices.insert(vertices.end(), last_vertices.begin() + first, last_vertices.begin() + last);
+        if (offset != first)
+            dirty.add(offset, vertices.size());
+    };
+    reuse(m_points, m_last_frame.points, chunk.begin.points, chunk.end.points, m_dirty.points);
+    reuse(m_points_selection_invisible, m_last_frame.points_selection_invisible,
+          chunk.begin.points_selection_invisible, chunk.end.points_selection_invisible,
+          m_dirty.points_selection_invisible);
+    reuse(m_lines, m_last_frame.lines, chunk.begin.lines, chunk.end.lines, m_dirty.lines);
+    reuse(m_lines_selection_invisible, m_last_frame.lines_selection_invisible, chunk.begin.lines_selection_invisible,
+          chunk.end.lines_selection_invisible, m_dirty.lines_selection_invisible);
+    reuse(m_glyphs, m_last_frame.glyphs, chunk.begin.glyphs, chunk.end.glyphs, m_dirty.glyphs);
+    reuse(m_glyphs_3d, m_last_frame.glyphs_3d, chunk.begin.glyphs_3d, chunk.end.glyphs_3d, m_dirty.glyphs_3d);
+    reuse(m_icons, m_last_frame.icons, chunk.begin.icons, chunk.end.icons, m_dirty.icons);
+    reuse(m_icons_selection_invisible, m_last_frame.icons_selection_invisible, chunk.begin.icons_selection_invisible,
+          chunk.end.icons_selection_invisible, m_dirty.icons_selection_invisible);
+
+    m_face_groups.insert(m_face_groups.end(), m_last_frame.face_groups.begin() + chunk.begin.face_groups,
+                         m_last_frame.face_groups.begin() + chunk.end.face_groups);
+
+    for (const auto &[vref_rel, sr] : chunk.selectables) {
+        const VertexRef vref{vref_rel.type, vref_rel.index + begin.get(vref_rel.type)};
+        m_vertex_to_selectable_map.emplace(vref, sr);
+        m_selectable_to_vertex_map[sr].push_back(vref);
+    }
+
+    chunk.begin = begin;
+    chunk.end = get_array_sizes();
+    chunk.frame = m_frame;
+}
+
+std::optional<std::pair<glm::vec3, glm::vec3>> Canvas::get_chunk_bbox(const Chunk &chunk) const
+{
+    if (chunk.begin.points == chunk.end.points && chunk.begin.lines == chunk.end.lines)
+        return {};
+
+    MinMaxAccumulator<float> acc_x, acc_y, acc_z;
+    for (size_t i = chunk.begin.points; i < chunk.end.points; i++) {
+        const auto &pt = m_points.at(i);
+        acc_x.accumulate(pt.x);
+        acc_y.accumulate(pt.y);
+        acc_z.accumulate(pt.z);
+    }
+    for (size_t i = chunk.begin.lines; i < chunk.end.lines; i++) {
+        const auto &li = m_lines.at(i);
+        // extend to infinity
+        if ((li.flags & VertexFlags::SCREEN) != VertexFlags::DEFAULT)
+            return {};
+        acc_x.accumulate(li.x1);
+        acc_x.accumulate(li.x2);
+        acc_y.accumulate(li.y1);
+        acc_y.accumulate(li.y2);
+        acc_z.accumulate(li.z1);
+        acc_z.accumulate(li.z2);
+    }
+    return std::make_pair(glm::vec3(acc_x.get_min(), acc_y.get_min(), acc_z.get_min()),
+                          glm::vec3(acc_x.get_max(), acc_y.get_max(), acc_z.get_max()));
+}
+
+bool Canvas::is_culled(const std::pair<glm::vec3, glm::vec3> &bbox, float margin, float min_size) const
+{
+    const auto mvp = m_projmat * m_viewmat;
+    const auto &[a, b] = bbox;
+    std::array<glm::vec4, 8> corners;
+    size_t i = 0;
+    for (const auto &corner : {glm::vec3(a.x, a.y, a.z), glm::vec3(a.x, a.y, b.z), glm::vec3(a.x, b.y, a.z),
+                               glm::vec3(a.x, b.y, b.z), glm::vec3(b.x, a.y, a.z), glm::vec3(b.x, a.y, b.z),
+                               glm::vec3(b.x, b.y, a.z), glm::vec3(b.x, b.y, b.z)}) {
+        corners.at(i++) = mvp * glm::vec4(corner, 1);
+    }
+
+    // outside if all corners are beyond the same clipping plane
+    const float mx = 1 + margin * 2 / m_dev_width;
+    const float my = 1 + margin * 2 / m_dev_height;
+    auto all = [&corners](auto pred) { return std::ranges::all_of(corners, pred); };
+    if (all([mx](const auto &c) { return c.x > mx * c.w; }) || all([mx](const auto &c) { return c.x < -mx * c.w; })
+        || all([my](const auto &c) { return c.y > my * c.w; }) || all([my](const auto &c) { return c.y < -my * c.w; })
+        || all([](const auto &c) { return c.z > c.w; }) || all([](const auto &c) { return c.z < -c.w; }))
+        return true;
+
+    if (min_size == 0)
+        return false;
+
+    // the projected size is only meaningful if the box is entirely in front of the camera
+    if (!all([](const auto &c) { return c.w > 0; }))
+        return false;
+    MinMaxAccumulator<float> acc_x, acc_y;
+    for (const auto &c : corners) {
+        acc_x.accumulate(c.x / c.w);
+        acc_y.accumulate(c.y / c.w);
+    }
+    const float w = (acc_x.get_max() - acc_x.get_min()) * m_dev_width / 2;
+    const float h = (acc_y.get_max() - acc_y.get_min()) * m_dev_height / 2;
+    return std::max(w, h) < min_size;
+}
+
+void Canvas::update_culling()
+{
+    m_draw_ranges.clear();
+    m_face_groups_culled.assign(m_face_groups.size(), false);
+    if (!m_enable_culling)
+        return;
+
+    const float margin = s_cull_margin * m_scale_factor;
+    std::vector<std::pair<size_t, size_t>> culled_points;
+    std::vector<std::pair<size_t, size_t>> culled_lines;
+    for (const auto &[key, chunk] : m_chunks) {
+        if (chunk.frame != m_frame || !chunk.bbox)
+            continue;
+        if (!is_culled(*chunk.bbox, margin, 0))
+            continue;
+        if (chunk.end.points > chunk.begin.points)
+            culled_points.emplace_back(chunk.begin.points, chunk.end.points);
+        if (chunk.end.lines > chunk.begin.lines)
+            culled_lines.emplace_back(chunk.begin.lines, chunk.end.lines);
+    }
+
+    auto make_ranges = [this](VertexType type, std::vector<std::pair<size_t, size_t>> &culled, size_t count) {
+        if (culled.empty())
+            return;
+        std::ranges::sort(culled);
+        auto &ranges = m_draw_ranges[type];
+        size_t pos = 0;
+        for (const auto &[begin, end] : culled) {
+            if (begin > pos) {
+                ranges.first.push_back(pos);
+                ranges.count.push_back(begin - pos);
+            }
+            pos = std::max(pos, end);
+        }
+        if (count > pos) {
+            ranges.first.push_back(pos);
+            ranges.count.push_back(count - pos);
+        }
+    };
+    make_ranges(VertexType::POINT, culled_points, m_n_points);
+    make_ranges(VertexType::LINE, culled_lines, m_n_lines);
+
+    for (size_t i = 0; i < m_face_groups.size(); i++) {
+        if (auto bb = get_face_group_bbox(m_face_groups.at(i)))
+            m_face_groups_culled.at(i) = is_culled(*bb, 0, s_cull_min_size * m_scale_factor);
+    }
+}
+
+void Canvas::draw_arrays(VertexType type, GLenum mode, size_t count) const
+{
+    if (auto it = m_draw_ranges.find(type); it != m_draw_ranges.end()) {
+        const auto &ranges = it->second;
+        if (ranges.first.size())
+            glMultiDrawArrays(mode, ranges.first.data(), ranges.count.data(), ranges.first.size());
+    }
+    else {
+        glDrawArrays(mode, 0, count);
+    }
+}
+
 ICanvas::VertexRef Canvas::draw_point(glm::vec3 p)
 {
     auto &pts = m_selection_invisible ? m_points_selection_invisible : m_points;
@@ -1382,32 +1904,9 @@ void Canvas::add_selectable(const VertexRef &vref, const SelectableRef &sref)
         sr = m_override_selectable.value();
     m_vertex_to_selectable_map.emplace(vref, sr);
     m_selectable_to_vertex_map[sr].push_back(vref);
-}
-
-Canvas::VertexFlags &Canvas::get_vertex_flags(const VertexRef &vref)
-{
-    switch (vref.type) {
-    case VertexType::LINE:
-        return m_lines.at(vref.index).flags;
-
-    case VertexType::POINT:
-        return m_points.at(vref.index).flags;
-
-    case VertexType::GLYPH:
-        return m_glyphs.at(vref.index).flags;
-
-    case VertexType::GLYPH_3D:
-        return m_glyphs_3d.at(vref.index).flags;
-
-    case VertexType::FACE_GROUP:
-        return m_face_groups.at(vref.index).flags;
-
-    case VertexType::ICON:
-        return m_icons.at(vref.index).flags;
-
-    default:
-        throw std::runtime_error("unknown vertex type");
-    }
+    if (m_current_chunk)
+        m_current_chunk->selectables.emplace_back(
+                VertexRef{vref.type, vref.index - m_current_chunk->begin.get(vref.type)}, sr);
 }
 
 void Canvas::set_selection(const std::set<SelectableRef> &sel, bool emit)
@@ -1430,12 +1929,11 @@ void Canvas::set_flag_for_selectables(const std::set<SelectableRef> &sel, Vertex
             continue;
         auto &vrefs = m_selectable_to_vertex_map.at(sr);
         for (const auto &vref : vrefs) {
-            auto &flags = get_vertex_flags(vref);
-            flags |= flag;
+            set_pick_flags(vref, flag);
         }
-        // auto &flags = get_vertex_flags()
+        if (flag == VertexFlags::SELECTED)
+            m_selection.insert(sr);
     }
-    m_push_flags = static_cast<PushFlags>(m_push_flags | PF_LINES | PF_POINTS | PF_GLYPHS | PF_GLYPHS_3D | PF_ICONS);
     queue_draw();
 }
 
@@ -1447,57 +1945,13 @@ void Canvas::set_hover_selection(const std::optional<SelectableRef> &sr)
         return;
     auto &vrefs = m_selectable_to_vertex_map.at(*sr);
     for (const auto &vref : vrefs) {
-        auto &flags = get_vertex_flags(vref);
-        flags |= VertexFlags::HOVER;
+        set_pick_flags(vref, VertexFlags::HOVER);
     }
 }
 
 std::set<SelectableRef> Canvas::get_selection() const
 {
-    std::set<SelectableRef> r;
-    for (size_t i = 0; i < m_lines.size(); i++) {
-        if ((m_lines.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::LINE, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    for (size_t i = 0; i < m_points.size(); i++) {
-        if ((m_points.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::POINT, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    for (size_t i = 0; i < m_glyphs.size(); i++) {
-        if ((m_glyphs.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::GLYPH, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    for (size_t i = 0; i < m_glyphs_3d.size(); i++) {
-        if ((m_glyphs_3d.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::GLYPH_3D, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    for (size_t i = 0; i < m_face_groups.size(); i++) {
-        if ((m_face_groups.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::FACE_GROUP, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    for (size_t i = 0; i < m_icons.size(); i++) {
-        if ((m_icons.at(i).flags & VertexFlags::SELECTED) != VertexFlags::DEFAULT) {
-            const VertexRef vref{.type = VertexType::ICON, .index = i};
-            if (m_vertex_to_selectable_map.count(vref))
-                r.insert(m_vertex_to_selectable_map.at(vref));
-        }
-    }
-    return r;
+    return m_selection;
 }
 
 void Canvas::set_selection_mode(SelectionMode mode)
@@ -1511,8 +1965,6 @@ void Canvas::set_selection_mode(SelectionMode mode)
     }
     else if (m_selection_mode == SelectionMode::NONE) {
         clear_flags(VertexFlags::SELECTED | VertexFlags::HOVER);
-        m_push_flags =
-                static_cast<PushFlags>(m_push_flags | PF_LINES | PF_POINTS | PF_GLYPHS | PF_GLYPHS_3D | PF_ICONS);
         queue_draw();
     }
     m_signal_selection_mode_changed.emit();
@@ -1620,15 +2072,54 @@ void Canvas::update_bbox()
         acc_z.accumulate(li.z1);
         acc_z.accumulate(li.z2);
     }
-    for (const auto &fv : m_face_vertex_buffer) {
-        acc_x.accumulate(fv.x);
-        acc_y.accumulate(fv.y);
-        acc_z.accumulate(fv.z);
+    std::erase_if(m_faces_bboxes, [](const auto &it) { return it.second.faces.expired(); });
+    for (const auto &group : m_face_groups) {
+        if (auto bb = get_face_group_bbox(group)) {
+            for (const auto &p : {bb->first, bb->second}) {
+                acc_x.accumulate(p.x);
+                acc_y.accumulate(p.y);
+                acc_z.accumulate(p.z);
+            }
+        }
     }
     m_bbox.first = {acc_x.get_min(), acc_y.get_min(), acc_z.get_min()};
     m_bbox.second = {acc_x.get_max(), acc_y.get_max(), acc_z.get_max()};
 }
 
+std::optional<std::pair<glm::vec3, glm::vec3>> Canvas::get_face_group_bbox(const FaceGroup &group)
+{
+    auto &bb = m_faces_bboxes[group.faces.get()];
+    if (bb.faces.owner_before(group.faces) || group.faces.owner_before(bb.faces) || bb.faces.expired()) {
+        MinMaxAccumulator<float> fx, fy, fz;
+        bb.bbox.reset();
+        for (const auto &face : *group.faces) {
+            for (const auto &v : face.vertices) {
+                fx.accumulate(v.x);
+                fy.accumulate(v.y);
+                fz.accumulate(v.z);
+                bb.bbox.emplace();
+            }
+        }
+        bb.faces = group.faces;
+        if (bb.bbox)
+            bb.bbox = {{fx.get_min(), fy.get_min(), fz.get_min()}, {fx.get_max(), fy.get_max(), fz.get_max()}};
+    }
+    if (!bb.bbox)
+        return {};
+    MinMaxAccumulator<float> acc_x, acc_y, acc_z;
+    const auto &[a, b] = *bb.bbox;
+    for (const auto &corner : {glm::vec3(a.x, a.y, a.z), glm::vec3(a.x, a.y, b.z), glm::vec3(a.x, b.y, a.z),
+                               glm::vec3(a.x, b.y, b.z), glm::vec3(b.x, a.y, a.z), glm::vec3(b.x, a.y, b.z),
+                               glm::vec3(b.x, b.y, a.z), glm::vec3(b.x, b.y, b.z)}) {
+        const auto p = glm::rotate(group.normal, corner) + group.origin;
+        acc_x.accumulate(p.x);
+        acc_y.accumulate(p.y);
+        acc_z.accumulate(p.z);
+    }
+    return std::make_pair(glm::vec3(acc_x.get_min(), acc_y.get_min(), acc_z.get_min()),
+                          glm::vec3(acc_x.get_max(), acc_y.get_max(), acc_z.get_max()));
+}
+
 void Canvas::set_show_error_overlay(bool show)
 {
     m_show_error_overlay = show;
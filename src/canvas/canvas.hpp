@@ -20,8 +20,12 @@
 #include "clipping_planes.hpp"
 #include "rotation_scheme.hpp"
 #include "projection.hpp"
+#include "dirty_ranges.hpp"
+#include "faces_lod_generator.hpp"
 #include <glm/glm.hpp>
 #include <filesystem>
+#include <optional>
+#include <unordered_map>
 
 namespace dune3d {
 
@@ -67,7 +71,9 @@ public:
         m_vertex_construction = c;
     }
 
-    VertexRef add_face_group(const face::Faces &faces, glm::vec3 origin, glm::quat normal,
+    VertexRef add_face_group(std::shared_ptr<const face::Faces> faces, glm::vec3 origin, glm::quat normal,
+                             FaceColor face_color) override;
+    VertexRef add_face_group(std::shared_ptr<const face::FacesLOD> faces, glm::vec3 origin, glm::quat normal,
                              FaceColor face_color) override;
 
     VertexRef draw_icon(IconTexture::IconTextureID id, glm::vec3 origin, glm::vec2 shift, glm::vec3 v) override;
@@ -130,6 +136,13 @@ public:
     {
         m_enable_animations = e;
     }
+
+    // for checking whether culling is what's causing something to not show up
+    void set_enable_culling(bool e)
+    {
+        m_enable_culling = e;
+        queue_draw();
+    }
     bool get_enable_animations()
     {
         return m_enable_animations;
@@ -205,6 +218,9 @@ public:
 
     void set_transform(const glm::mat4 &transform) override;
 
+    bool begin_chunk(const UUID &key) override;
+    void end_chunk() override;
+
     void set_selection_menu_creator(ISelectionMenuCreator &creator)
     {
         m_selection_menu_creator = &creator;
@@ -221,7 +237,6 @@ private:
     BoxSelection m_box_selection;
     SelectionTextureRenderer m_selection_texture_renderer;
     std::vector<BaseRenderer *> m_all_renderers;
-    unsigned int m_pick_base = 1;
 
     GLint get_samples() const;
 
@@ -231,7 +246,7 @@ private:
 
     void on_realize() override;
     bool on_render(const Glib::RefPtr<Gdk::GLContext> &context) override;
-    void render_all(std::vector<pick_buf_t> &pick_buf);
+    void render_all();
     void peel_selection();
     void on_resize(int width, int height) override;
     void resize_buffers();
@@ -255,9 +270,6 @@ private:
         uint8_t _pad;
     } __attribute__((packed));
 
-    std::vector<FaceVertex> m_face_vertex_buffer;  // vertices of all models, sequentially
-    std::vector<unsigned int> m_face_index_buffer; // indexes face_vertex_buffer to form triangles
-
     glm::mat4 m_viewmat;
     glm::mat4 m_projmat;
     glm::mat4 m_projmat_viewmat_inv;
@@ -273,8 +285,54 @@ private:
     std::filesystem::path m_pick_path;
 
 
-    std::vector<pick_buf_t> m_pick_buf;
-    pick_buf_t read_pick_buf(const std::vector<pick_buf_t> &pick_buf, int x, int y) const;
+    // rectangle in device pixels with the origin at the bottom left like in GL, inclusive
+    struct PickRect {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = -1;
+        int y1 = -1;
+
+        int get_width() const
+        {
+            return x1 - x0 + 1;
+        }
+        int get_height() const
+        {
+            return y1 - y0 + 1;
+        }
+        bool contains(const PickRect &other) const
+        {
+            return other.x0 >= x0 && other.x1 <= x1 && other.y0 >= y0 && other.y1 <= y1;
+        }
+    };
+
+    // part of the downsampled pick buffer that has been read back, the full
+    // buffer is only read if needed since that's a lot of data on large screens
+    struct PickRegion {
+        PickRect rect;
+        std::vector<pick_buf_t> data;
+    };
+    PickRegion m_pick_region;
+    pick_buf_t read_pick_buf(const PickRegion &region, int x, int y) const;
+    PickRect get_pick_rect(int x0, int y0, int x1, int y1, int margin) const;
+    void read_pick_region(PickRegion &region, const PickRect &rect);
+    // makes sure that the given rectangle in widget coordinates is in m_pick_region
+    void fetch_pick_region(int x0, int y0, int x1, int y1);
+
+    // the region around the cursor gets read asynchronously after each frame
+    // so that it's usually there when the hover selection needs it
+    GLuint m_pick_pbo = 0;
+    GLsync m_pick_fence = nullptr;
+    PickRect m_pick_pbo_rect;
+    void start_pick_readback();
+    void finish_pick_readback();
+    void discard_pick_readback();
+
+    // false if the downsampled pick buffer doesn't contain the last frame
+    // anymore, such as after selection peeling
+    bool m_pick_fb_current = false;
+    static constexpr int s_pick_readback_margin = 32;
+    static constexpr int s_hover_box_size = 10;
 
     GLuint m_renderbuffer;
     GLuint m_fbo;
@@ -493,25 +551,139 @@ private:
 
     void clear_flags(VertexFlags flags);
 
-    void add_faces(const face::Faces &faces);
+    // selection, hover and highlight of each vertex, kept apart from the
+    // vertices so that changing them only uploads the flags of the affected
+    // picks to the GPU, see push_pick_flags
+    struct PickFlags {
+        std::vector<uint8_t> flags; // indexed by vertex, may be shorter than the vertex array
+        DirtyRanges dirty;
+    };
+    std::map<VertexType, PickFlags> m_pick_flags;
+    VertexFlags get_pick_flags(const VertexRef &vref) const;
+    void set_pick_flags(const VertexRef &vref, VertexFlags flags);
+
+    GLuint m_pick_flags_buffer = 0;
+    GLuint m_pick_flags_texture = 0;
+    std::vector<size_t> m_pushed_pick_flags_sizes;
+    static constexpr GLuint s_pick_flags_texture_unit = 3;
+    void update_vertex_type_picks();
+    void push_pick_flags();
+
     class FaceGroup {
     public:
-        size_t offset;
-        size_t length;
+        // the face renderer keeps a vertex buffer for each of these
+        std::shared_ptr<const face::Faces> faces;
+        // if set, faces is one of its levels
+        std::shared_ptr<const face::FacesLOD> lod;
         glm::vec3 origin;
         glm::quat normal;
         FaceColor color;
-
-        VertexFlags flags = VertexFlags::DEFAULT;
     };
 
     std::vector<FaceGroup> m_face_groups;
 
-    std::map<VertexRef, SelectableRef> m_vertex_to_selectable_map;
-    std::map<SelectableRef, std::vector<VertexRef>> m_selectable_to_vertex_map;
+    // bounding box of each face group's faces, before transforming them
+    struct FacesBBox {
+        std::weak_ptr<const face::Faces> faces;
+        std::optional<std::pair<glm::vec3, glm::vec3>> bbox;
+    };
+    std::map<const face::Faces *, FacesBBox> m_faces_bboxes;
+    std::optional<std::pair<glm::vec3, glm::vec3>> get_face_group_bbox(const FaceGroup &group);
+
+    // device pixels the mesh of a face group may deviate from its surface
+    static constexpr float s_lod_max_error = 2;
+    unsigned int get_lod_level(const std::pair<glm::vec3, glm::vec3> &bbox) const;
+    void update_face_lods();
+    face::FacesLODGenerator m_lod_generator;
+
+    std::unordered_map<VertexRef, SelectableRef> m_vertex_to_selectable_map;
+    std::unordered_map<SelectableRef, std::vector<VertexRef>> m_selectable_to_vertex_map;
+
+    // the selectables whose vertices have the SELECTED flag set,
+    // kept along with the flags so that getting it doesn't need to look at all vertices
+    std::set<SelectableRef> m_selection;
+
+    struct ArraySizes {
+        size_t points = 0;
+        size_t points_selection_invisible = 0;
+        size_t lines = 0;
+        size_t lines_selection_invisible = 0;
+        size_t glyphs = 0;
+        size_t glyphs_3d = 0;
+        size_t icons = 0;
+        size_t icons_selection_invisible = 0;
+        size_t face_groups = 0;
+
+        size_t get(VertexType type) const;
+    };
+    ArraySizes get_array_sizes() const;
+
+    // the vertex arrays of the last frame, reused chunks get copied from there
+    struct {
+        std::vector<PointVertex> points;
+        std::vector<PointVertex> points_selection_invisible;
+        std::vector<LineVertex> lines;
+        std::vector<LineVertex> lines_selection_invisible;
+        std::vector<GlyphVertex> glyphs;
+        std::vector<Glyph3DVertex> glyphs_3d;
+        std::vector<IconVertex> icons;
+        std::vector<IconVertex> icons_selection_invisible;
+        std::vector<FaceGroup> face_groups;
+    } m_last_frame;
+
+    struct DirtyArrays {
+        DirtyRanges points;
+        DirtyRanges points_selection_invisible;
+        DirtyRanges lines;
+        DirtyRanges lines_selection_invisible;
+        DirtyRanges glyphs;
+        DirtyRanges glyphs_3d;
+        DirtyRanges icons;
+        DirtyRanges icons_selection_invisible;
+
+        void set_all();
+        void reset();
+    };
+    DirtyArrays m_dirty;
+    void mark_dirty_since(const ArraySizes &sizes);
 
+    class Chunk {
+    public:
+        // where the chunk ended up in the vertex arrays of the frame it's been drawn in
+        ArraySizes begin;
+        ArraySizes end;
+        unsigned int frame = 0;
+        // relative to begin
+        std::vector<std::pair<VertexRef, SelectableRef>> selectables;
+        // of its points and lines, unset if the chunk can't be culled
+        std::optional<std::pair<glm::vec3, glm::vec3>> bbox;
+    };
+    std::map<UUID, Chunk> m_chunks;
+    Chunk *m_current_chunk = nullptr;
+    unsigned int m_chunk_depth = 0;
+    unsigned int m_frame = 0;
+    ArraySizes m_unchunked_begin;
+    void reuse_chunk(Chunk &chunk);
+    std::optional<std::pair<glm::vec3, glm::vec3>> get_chunk_bbox(const Chunk &chunk) const;
+
+    // chunks are culled if they're entirely outside of the view, face groups
+    // also if they'd end up smaller than s_cull_min_size
+    bool m_enable_culling = true;
+    static constexpr float s_cull_min_size = 1;
+    // device pixels points and lines may extend beyond their vertices
+    static constexpr float s_cull_margin = 16;
+    struct DrawRanges {
+        std::vector<GLint> first;
+        std::vector<GLsizei> count;
+    };
+    // ranges of the points and lines that aren't culled
+    std::map<VertexType, DrawRanges> m_draw_ranges;
+    std::vector<bool> m_face_groups_culled;
+    void update_culling();
+    bool is_culled(const std::pair<glm::vec3, glm::vec3> &bbox, float margin, float min_size) const;
+    // draws count vertices of the given type, skipping the culled ones
+    void draw_arrays(VertexType type, GLenum mode, size_t count) const;
 
-    VertexFlags &get_vertex_flags(const VertexRef &vref);
 
     struct PickInfo {
         size_t offset;
@@ -528,8 +700,8 @@ private:
 
     double m_last_x = 0, m_last_y = 0;
     void update_hover_selection();
-    unsigned int get_hover_pick() const;
-    unsigned int get_hover_pick(const std::vector<pick_buf_t> &pick_buf) const;
+    unsigned int get_hover_pick();
+    unsigned int get_hover_pick(const PickRegion &region) const;
 
     type_signal_view_changed m_signal_view_changed;
     type_signal_view_changed m_signal_cursor_moved;
@@ -0,0 +1,37 @@
+#include "dirty_ranges.hpp"
+#include <algorithm>
+
+namespace dune3d {
+
+void DirtyRanges::add(size_t first, size_t last)
+{
+    if (m_all || first >= last)
+        return;
+    // consecutive vertices usually get marked one after another
+    if (m_ranges.size() && m_ranges.back().second == first)
+        m_ranges.back().second = last;
+    else
+        m_ranges.emplace_back(first, last);
+}
+
+void DirtyRanges::reset()
+{
+    m_all = false;
+    m_ranges.clear();
+}
+
+std::vector<DirtyRanges::Range> DirtyRanges::get_merged(size_t gap) const
+{
+    auto ranges = m_ranges;
+    std::ranges::sort(ranges);
+    std::vector<Range> merged;
+    for (const auto &range : ranges) {
+        if (merged.size() && range.first <= merged.back().second + gap)
+            merged.back().second = std::max(merged.back().second, range.second);
+        else
+            merged.push_back(range);
+    }
+    return merged;
+}
+
+} // namespace dune3d
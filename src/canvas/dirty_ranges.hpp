@@ -0,0 +1,84 @@
+#pragma once
+#include <epoxy/gl.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace dune3d {
+
+// Ranges of a vertex array that have changed since it's been pushed to the GPU
+class DirtyRanges {
+public:
+    using Range = std::pair<size_t, size_t>; // first, last (exclusive)
+
+    void add(size_t first, size_t last);
+    void add(size_t index)
+    {
+        add(index, index + 1);
+    }
+
+    // for when the contents of the buffer on the GPU aren't known
+    void set_all()
+    {
+        m_all = true;
+    }
+    bool is_all() const
+    {
+        return m_all;
+    }
+
+    void reset();
+
+    // sorted, ranges that are less than gap apart get merged so that
+    // scattered changes don't result in lots of tiny uploads
+    std::vector<Range> get_merged(size_t gap) const;
+
+private:
+    bool m_all = true;
+    std::vector<Range> m_ranges;
+};
+
+template <typename T> struct BufferPart {
+    const std::vector<T> &data;
+    const DirtyRanges &dirty;
+};
+
+// Places the parts back to back in the buffer bound to target. Only the dirty
+// ranges get uploaded unless the sizes of the parts have changed since the last push.
+template <typename T>
+void push_buffer_parts(GLenum target, std::vector<size_t> &pushed_sizes, const std::vector<BufferPart<T>> &parts)
+{
+    std::vector<size_t> sizes;
+    bool all = false;
+    for (const auto &part : parts) {
+        sizes.push_back(part.data.size());
+        all = all || part.dirty.is_all();
+    }
+
+    if (all || sizes != pushed_sizes) {
+        size_t total = 0;
+        for (const auto size : sizes)
+            total += size;
+        glBufferData(target, sizeof(T) * total, nullptr, GL_STATIC_DRAW);
+        size_t offset = 0;
+        for (const auto &part : parts) {
+            glBufferSubData(target, sizeof(T) * offset, sizeof(T) * part.data.size(), part.data.data());
+            offset += part.data.size();
+        }
+        pushed_sizes = sizes;
+        return;
+    }
+
+    size_t offset = 0;
+    for (const auto &part : parts) {
+        for (auto [first, last] : part.dirty.get_merged(64)) {
+            last = std::min(last, part.data.size());
+            if (first >= last)
+                continue;
+            glBufferSubData(target, sizeof(T) * (offset + first), sizeof(T) * (last - first), part.data.data() + first);
+        }
+        offset += part.data.size();
+    }
+}
+
+} // namespace dune3d
@@ -2,6 +2,7 @@
 #include "gl_util.hpp"
 #include "canvas.hpp"
 #include <cmath>
+#include <set>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -12,30 +13,43 @@ FaceRenderer::FaceRenderer(Canvas &c) : BaseRenderer(c, Canvas::VertexType::FACE
 {
 }
 
-void FaceRenderer::create_vao()
+void FaceRenderer::create_buffers(Buffers &buffers, const face::Faces &faces)
 {
     GLuint position_index = glGetAttribLocation(m_program, "position");
     GLuint normal_index = glGetAttribLocation(m_program, "normal");
     GLuint color_index = glGetAttribLocation(m_program, "color");
 
+    std::vector<Canvas::FaceVertex> vertices;
+    std::vector<unsigned int> indices;
+    for (const auto &face : faces) {
+        const size_t vertex_offset = vertices.size();
+        for (size_t i = 0; i < face.vertices.size(); i++) {
+            const auto &v = face.vertices.at(i);
+            const auto &n = face.normals.at(i);
+            vertices.emplace_back(v.x, v.y, v.z, n.x, n.y, n.z, face.color.r * 255, face.color.g * 255,
+                                  face.color.b * 255);
+        }
 
-    /* we need to create a VAO to store the other buffers */
-    glGenVertexArrays(1, &m_vao);
-    glBindVertexArray(m_vao);
-
-    /* this is the VBO that holds the vertex data */
-    glGenBuffers(1, &m_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        for (const auto &tri : face.triangle_indices) {
+            size_t a, b, c;
+            std::tie(a, b, c) = tri;
+            indices.push_back(a + vertex_offset);
+            indices.push_back(b + vertex_offset);
+            indices.push_back(c + vertex_offset);
+        }
+    }
 
-    glGenBuffers(1, &m_ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glGenVertexArrays(1, &buffers.vao);
+    glBindVertexArray(buffers.vao);
 
-    std::vector<Canvas::FaceVertex> vertices = {
-            {-1, -1, 0, 0, 0, 1, 255, 0, 0}, {1, .1, 0, 0, 0, 1, 255, 0, 0}, {0, -.1, 0, 0, 0, 1, 255, 0, 0}};
+    glGenBuffers(1, &buffers.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::FaceVertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
-    uint32_t elements[] = {0, 1, 2};
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+    glGenBuffers(1, &buffers.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    buffers.n_indices = indices.size();
 
     /* enable and set the position attribute */
     glEnableVertexAttribArray(position_index);
@@ -48,17 +62,25 @@ void FaceRenderer::create_vao()
     glVertexAttribPointer(color_index, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Canvas::FaceVertex),
                           (void *)offsetof(Canvas::FaceVertex, r));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
-    // glDeleteBuffers (1, &buffer);
+void FaceRenderer::delete_buffers(Buffers &buffers)
+{
+    glDeleteVertexArrays(1, &buffers.vao);
+    glDeleteBuffers(1, &buffers.vbo);
+    glDeleteBuffers(1, &buffers.ebo);
+    buffers = {};
 }
 
 void FaceRenderer::realize()
 {
     m_program = gl_create_program_from_resource("/org/dune3d/dune3d/canvas/shaders/face-vertex.glsl",
                                                 "/org/dune3d/dune3d/canvas/shaders/face-fragment.glsl", nullptr);
-    create_vao();
+    // buffers from a previous context are gone
+    m_buffers.clear();
 
     realize_base();
 
@@ -73,19 +95,29 @@ void FaceRenderer::realize()
 
 void FaceRenderer::push()
 {
-
-    auto n_vertices = m_ca.m_face_vertex_buffer.size();
-    auto n_idx = m_ca.m_face_index_buffer.size();
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::FaceVertex) * n_vertices, m_ca.m_face_vertex_buffer.data(),
-                 GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * n_idx, m_ca.m_face_index_buffer.data(),
-                 GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    std::set<const face::Faces *> used;
+    for (const auto &group : m_ca.m_face_groups) {
+        auto &buffers = m_buffers[group.faces.get()];
+        used.insert(group.faces.get());
+        // same address, but possibly different faces if the old ones got freed in the meantime
+        const bool same_faces = !buffers.faces.owner_before(group.faces) && !group.faces.owner_before(buffers.faces)
+                                && !buffers.faces.expired();
+        if (same_faces)
+            continue;
+        if (buffers.vao)
+            delete_buffers(buffers);
+        create_buffers(buffers, *group.faces);
+        buffers.faces = group.faces;
+    }
+    for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+        if (!used.contains(it->first)) {
+            delete_buffers(it->second);
+            it = m_buffers.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
 }
 
 static int get_clipping_op(const ClippingPlanes::Plane &plane)
@@ -101,8 +133,6 @@ static int get_clipping_op(const ClippingPlanes::Plane &plane)
 void FaceRenderer::render()
 {
     glUseProgram(m_program);
-    glBindVertexArray(m_vao);
-    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
     load_uniforms();
     glm::vec3 clipping_value;
@@ -123,8 +153,13 @@ void FaceRenderer::render()
 
     size_t group_idx = 0;
     for (const auto &group : m_ca.m_face_groups) {
-        glUniform1ui(m_pick_base_loc, m_ca.m_pick_base + group_idx);
-        glUniform1ui(m_flags_loc, static_cast<uint32_t>(group.flags));
+        if (m_ca.m_face_groups_culled.at(group_idx)) {
+            group_idx++;
+            continue;
+        }
+        glUniform1ui(m_pick_base_loc, m_ca.m_vertex_type_picks.at(Canvas::VertexType::FACE_GROUP).offset + group_idx);
+        glUniform1ui(m_flags_loc,
+                     static_cast<uint32_t>(m_ca.get_pick_flags({Canvas::VertexType::FACE_GROUP, group_idx})));
         glUniform3fv(m_origin_loc, 1, glm::value_ptr(group.origin));
         if (group.color == ICanvas::FaceColor::AS_IS) {
             glUniform3f(m_override_color_loc, NAN, NAN, NAN);
@@ -138,18 +173,19 @@ void FaceRenderer::render()
         glm::mat3 normal_mat = glm::transpose(glm::toMat3(group.normal));
 
         glUniformMatrix3fv(m_normal_mat_loc, 1, GL_FALSE, glm::value_ptr(normal_mat));
-        glDrawElements(GL_TRIANGLES, group.length, GL_UNSIGNED_INT, (void *)(group.offset * sizeof(unsigned int)));
+        if (auto it = m_buffers.find(group.faces.get()); it != m_buffers.end()) {
+            glBindVertexArray(it->second.vao);
+            glDrawElements(GL_TRIANGLES, it->second.n_indices, GL_UNSIGNED_INT, 0);
+        }
         group_idx++;
     }
-    m_ca.m_vertex_type_picks[Canvas::VertexType::FACE_GROUP] = {.offset = m_ca.m_pick_base,
-                                                                .count = m_ca.m_face_groups.size()};
-    m_ca.m_pick_base += m_ca.m_face_groups.size();
+    glBindVertexArray(0);
 }
 
 
 size_t FaceRenderer::get_vertex_count() const
 {
-    return m_ca.m_n_glyphs;
+    return m_ca.m_face_groups.size();
 }
 
 
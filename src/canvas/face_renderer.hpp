@@ -1,5 +1,8 @@
 #pragma once
 #include "base_renderer.hpp"
+#include "face.hpp"
+#include <map>
+#include <memory>
 
 namespace dune3d {
 class FaceRenderer : public BaseRenderer {
@@ -11,11 +14,19 @@ public:
 
 private:
     size_t get_vertex_count() const override;
-    void create_vao();
 
-    GLuint m_vao;
-    GLuint m_vbo;
-    GLuint m_ebo;
+    // one set of buffers for each face::Faces, so that unchanged solid models
+    // don't need to be uploaded again on every canvas update
+    struct Buffers {
+        std::weak_ptr<const face::Faces> faces;
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLuint ebo = 0;
+        size_t n_indices = 0;
+    };
+    std::map<const face::Faces *, Buffers> m_buffers;
+    void create_buffers(Buffers &buffers, const face::Faces &faces);
+    void delete_buffers(Buffers &buffers);
 
     GLuint m_cam_normal_loc;
     GLuint m_flags_loc;
@@ -0,0 +1,61 @@
+#include "faces_lod.hpp"
+#include <cmath>
+
+namespace dune3d::face {
+
+static constexpr float s_base_deflection = 0.14;
+static constexpr float s_base_angle = 0.52359878;
+
+FacesLOD::FacesLOD(const Faces &base, Generator generator) : m_base(base), m_generator(generator)
+{
+}
+
+float FacesLOD::get_deflection(unsigned int level)
+{
+    return s_base_deflection * std::pow(4.f, (int)level - (int)s_base_level);
+}
+
+float FacesLOD::get_angle(unsigned int level)
+{
+    return s_base_angle * std::pow(1.5f, (int)level - (int)s_base_level);
+}
+
+void FacesLOD::set_level(unsigned int level, Faces faces)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (level != s_base_level)
+        m_levels.at(level) = std::move(faces);
+}
+
+const Faces &FacesLOD::get_level(unsigned int level) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    while (level != s_base_level) {
+        // levels don't change once they've been set, so they can be used without holding the lock
+        if (auto &faces = m_levels.at(level))
+            return *faces;
+        if (level < s_base_level)
+            level++;
+        else
+            level--;
+    }
+    return m_base;
+}
+
+bool FacesLOD::request_level(unsigned int level) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (level == s_base_level || !m_generator || m_levels.at(level) || m_requested.at(level))
+        return false;
+    m_requested.at(level) = true;
+    return true;
+}
+
+void FacesLOD::create_level(unsigned int level) const
+{
+    auto faces = m_generator(get_deflection(level), get_angle(level));
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_levels.at(level) = std::move(faces);
+}
+
+} // namespace dune3d::face
@@ -0,0 +1,52 @@
+#pragma once
+#include "face.hpp"
+#include <array>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace dune3d::face {
+
+// The same faces meshed with different tolerances so that the canvas can
+// draw them with as much detail as their size on screen calls for. Level
+// s_base_level is the mesh the faces have been created with, lower levels
+// are finer, higher levels coarser. Other levels are created on demand by
+// FacesLODGenerator.
+class FacesLOD {
+public:
+    using Generator = std::function<Faces(float deflection, float angle)>;
+
+    // base needs to outlive this object
+    FacesLOD(const Faces &base, Generator generator = nullptr);
+
+    static constexpr unsigned int s_n_levels = 4;
+    static constexpr unsigned int s_base_level = 1;
+
+    // maximum distance between mesh and surface
+    static float get_deflection(unsigned int level);
+    // maximum angle between adjacent normals
+    static float get_angle(unsigned int level);
+
+    // for levels that have been created elsewhere, such as when importing
+    void set_level(unsigned int level, Faces faces);
+
+    // falls back to the closest available level towards the base one
+    // if the requested one isn't available, never creates any levels
+    const Faces &get_level(unsigned int level) const;
+
+    // Returns true if the level still needs to be created. Only does so once
+    // for each level, so that it gets requested only once.
+    bool request_level(unsigned int level) const;
+    // may take long, so doesn't block get_level while doing so
+    void create_level(unsigned int level) const;
+
+private:
+    const Faces &m_base;
+    Generator m_generator;
+
+    mutable std::mutex m_mutex;
+    mutable std::array<std::optional<Faces>, s_n_levels> m_levels;
+    mutable std::array<bool, s_n_levels> m_requested = {};
+};
+
+} // namespace dune3d::face
@@ -0,0 +1,69 @@
+#include "faces_lod_generator.hpp"
+#include "faces_lod.hpp"
+#include "logger/logger.hpp"
+#include <glibmm.h>
+
+namespace dune3d::face {
+
+FacesLODGenerator::FacesLODGenerator()
+{
+    m_dispatcher.connect([this] { m_signal_done.emit(); });
+    m_thread = std::thread(&FacesLODGenerator::worker_thread, this);
+}
+
+void FacesLODGenerator::submit(std::shared_ptr<const FacesLOD> lod, unsigned int level)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_jobs.emplace_back(std::move(lod), level);
+    }
+    m_cond.notify_one();
+}
+
+void FacesLODGenerator::worker_thread()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_exit || m_jobs.size(); });
+            if (m_exit)
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        // nobody but us is using the faces anymore, such as after the solid model got updated
+        if (job.lod.use_count() == 1)
+            continue;
+
+        // the level stays missing, so the closest one keeps being drawn
+        try {
+            job.lod->create_level(job.level);
+        }
+        catch (const std::exception &e) {
+            Logger::log_critical("error creating level of detail", Logger::Domain::CANVAS, e.what());
+        }
+        catch (const Glib::Error &e) {
+            Logger::log_critical("error creating level of detail", Logger::Domain::CANVAS, e.what());
+        }
+        catch (...) {
+            Logger::log_critical("error creating level of detail", Logger::Domain::CANVAS, "unknown error");
+        }
+        job.lod.reset();
+        m_dispatcher.emit();
+    }
+}
+
+FacesLODGenerator::~FacesLODGenerator()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_exit = true;
+        m_jobs.clear();
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+} // namespace dune3d::face
@@ -0,0 +1,51 @@
+#pragma once
+#include <glibmm/dispatcher.h>
+#include <sigc++/sigc++.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace dune3d::face {
+
+class FacesLOD;
+
+// Creates levels of FacesLOD on a background thread, so that meshing them
+// doesn't stall drawing. Meanwhile, get_level returns the closest level
+// that's available.
+class FacesLODGenerator {
+public:
+    FacesLODGenerator();
+
+    // level needs to have been requested using FacesLOD::request_level
+    void submit(std::shared_ptr<const FacesLOD> lod, unsigned int level);
+
+    // emitted on the main thread whenever a level has been created
+    using type_signal_done = sigc::signal<void()>;
+    type_signal_done signal_done()
+    {
+        return m_signal_done;
+    }
+
+    ~FacesLODGenerator();
+
+private:
+    struct Job {
+        std::shared_ptr<const FacesLOD> lod;
+        unsigned int level;
+    };
+
+    void worker_thread();
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Job> m_jobs;
+    bool m_exit = false;
+
+    Glib::Dispatcher m_dispatcher;
+    type_signal_done m_signal_done;
+    std::thread m_thread;
+};
+
+} // namespace dune3d::face
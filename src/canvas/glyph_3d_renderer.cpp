@@ -97,8 +97,9 @@ void Glyph3DRenderer::push()
     m_ca.m_n_glyphs_3d = m_ca.m_glyphs_3d.size();
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::Glyph3DVertex) * m_ca.m_n_glyphs_3d, m_ca.m_glyphs_3d.data(),
-                 GL_STATIC_DRAW);
+    push_buffer_parts<Canvas::Glyph3DVertex>(GL_ARRAY_BUFFER, m_pushed_sizes,
+                                             {{m_ca.m_glyphs_3d, m_ca.m_dirty.glyphs_3d}});
+    m_ca.m_dirty.glyphs_3d.reset();
 }
 
 void Glyph3DRenderer::render()
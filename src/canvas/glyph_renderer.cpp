@@ -98,7 +98,8 @@ void GlyphRenderer::push()
     m_ca.m_n_glyphs = m_ca.m_glyphs.size();
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::GlyphVertex) * m_ca.m_n_glyphs, m_ca.m_glyphs.data(), GL_STATIC_DRAW);
+    push_buffer_parts<Canvas::GlyphVertex>(GL_ARRAY_BUFFER, m_pushed_sizes, {{m_ca.m_glyphs, m_ca.m_dirty.glyphs}});
+    m_ca.m_dirty.glyphs.reset();
 }
 
 void GlyphRenderer::render()
@@ -1,7 +1,10 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <tuple>
+#include <memory>
 #include "face.hpp"
+#include "faces_lod.hpp"
+#include "util/uuid.hpp"
 #include <glm/gtx/quaternion.hpp>
 
 namespace dune3d {
@@ -33,7 +36,11 @@ public:
 
     // virtual void add_faces(const face::Faces &faces) = 0;
     enum class FaceColor { AS_IS, SOLID_MODEL, OTHER_BODY_SOLID_MODEL };
-    virtual VertexRef add_face_group(const face::Faces &faces, glm::vec3 origin, glm::quat normal,
+    // faces are kept by reference, so that their vertex buffer can be reused across redraws
+    virtual VertexRef add_face_group(std::shared_ptr<const face::Faces> faces, glm::vec3 origin, glm::quat normal,
+                                     FaceColor face_color) = 0;
+    // draws the level of detail that fits the faces' size on screen
+    virtual VertexRef add_face_group(std::shared_ptr<const face::FacesLOD> faces, glm::vec3 origin, glm::quat normal,
                                      FaceColor face_color) = 0;
     virtual VertexRef draw_icon(IconTexture::IconTextureID id, glm::vec3 origin, glm::vec2 shift,
                                 glm::vec3 v = {NAN, NAN, NAN}) = 0;
@@ -44,6 +51,14 @@ public:
     virtual void add_selectable(const VertexRef &vref, const SelectableRef &sref) = 0;
     virtual void set_selection_invisible(bool selection_invisible) = 0;
 
+    // Everything drawn between begin_chunk and end_chunk is kept across clear.
+    // If the last frame had a chunk with the same key, begin_chunk reuses its
+    // contents and returns false, nothing must be drawn and end_chunk
+    // mustn't be called in that case. The key needs to cover all state that
+    // affects what gets drawn.
+    virtual bool begin_chunk(const UUID &key) = 0;
+    virtual void end_chunk() = 0;
+
     virtual void set_transform(const glm::mat4 &transform) = 0;
     virtual void set_override_selectable(const SelectableRef &sr) = 0;
     virtual void unset_override_selectable() = 0;
@@ -51,3 +66,12 @@ public:
     virtual void update_bbox() = 0;
 };
 } // namespace dune3d
+
+namespace std {
+template <> struct hash<dune3d::ICanvas::VertexRef> {
+    std::size_t operator()(const dune3d::ICanvas::VertexRef &k) const
+    {
+        return k.index * 8 + static_cast<size_t>(k.type);
+    }
+};
+} // namespace std
@@ -134,12 +134,11 @@ void IconRenderer::push()
     m_ca.m_n_icons_selection_invisible = m_ca.m_icons_selection_invisible.size();
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::IconVertex) * (m_ca.m_n_icons + m_ca.m_n_icons_selection_invisible),
-                 nullptr, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Canvas::IconVertex) * m_ca.m_n_icons, m_ca.m_icons.data());
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(Canvas::IconVertex) * m_ca.m_n_icons,
-                    sizeof(Canvas::IconVertex) * m_ca.m_n_icons_selection_invisible,
-                    m_ca.m_icons_selection_invisible.data());
+    push_buffer_parts<Canvas::IconVertex>(GL_ARRAY_BUFFER, m_pushed_sizes,
+                                          {{m_ca.m_icons, m_ca.m_dirty.icons},
+                                           {m_ca.m_icons_selection_invisible, m_ca.m_dirty.icons_selection_invisible}});
+    m_ca.m_dirty.icons.reset();
+    m_ca.m_dirty.icons_selection_invisible.reset();
 }
 
 void IconRenderer::render()
@@ -72,12 +72,11 @@ void LineRenderer::push()
     m_ca.m_n_lines = m_ca.m_lines.size();
     m_ca.m_n_lines_selection_invisible = m_ca.m_lines_selection_invisible.size();
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::LineVertex) * (m_ca.m_n_lines + m_ca.m_n_lines_selection_invisible),
-                 nullptr, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Canvas::LineVertex) * m_ca.m_n_lines, m_ca.m_lines.data());
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(Canvas::LineVertex) * m_ca.m_n_lines,
-                    sizeof(Canvas::LineVertex) * m_ca.m_n_lines_selection_invisible,
-                    m_ca.m_lines_selection_invisible.data());
+    push_buffer_parts<Canvas::LineVertex>(GL_ARRAY_BUFFER, m_pushed_sizes,
+                                          {{m_ca.m_lines, m_ca.m_dirty.lines},
+                                           {m_ca.m_lines_selection_invisible, m_ca.m_dirty.lines_selection_invisible}});
+    m_ca.m_dirty.lines.reset();
+    m_ca.m_dirty.lines_selection_invisible.reset();
 }
 
 void LineRenderer::render()
@@ -96,7 +95,7 @@ void LineRenderer::render()
 #ifndef __APPLE__
     glLineWidth(m_ca.m_appearance.line_width * m_ca.m_scale_factor);
 #endif
-    glDrawArrays(GL_POINTS, 0, m_ca.m_n_lines);
+    m_ca.draw_arrays(Canvas::VertexType::LINE, GL_POINTS, m_ca.m_n_lines);
     glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     glDrawArrays(GL_POINTS, m_ca.m_n_lines, m_ca.m_n_lines_selection_invisible);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
@@ -65,12 +65,12 @@ void PointRenderer::push()
     m_ca.m_n_points = m_ca.m_points.size();
     m_ca.m_n_points_selection_invisible = m_ca.m_points_selection_invisible.size();
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Canvas::PointVertex) * (m_ca.m_n_points + m_ca.m_n_points_selection_invisible),
-                 nullptr, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Canvas::PointVertex) * m_ca.m_n_points, m_ca.m_points.data());
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(Canvas::PointVertex) * m_ca.m_n_points,
-                    sizeof(Canvas::PointVertex) * m_ca.m_n_points_selection_invisible,
-                    m_ca.m_points_selection_invisible.data());
+    push_buffer_parts<Canvas::PointVertex>(
+            GL_ARRAY_BUFFER, m_pushed_sizes,
+            {{m_ca.m_points, m_ca.m_dirty.points},
+             {m_ca.m_points_selection_invisible, m_ca.m_dirty.points_selection_invisible}});
+    m_ca.m_dirty.points.reset();
+    m_ca.m_dirty.points_selection_invisible.reset();
 }
 
 void PointRenderer::render()
@@ -85,7 +85,7 @@ void PointRenderer::render()
     glUniform1f(m_z_offset_loc, 0);
 
     glPointSize(10 * m_ca.m_scale_factor);
-    glDrawArrays(GL_POINTS, 0, m_ca.m_n_points);
+    m_ca.draw_arrays(Canvas::VertexType::POINT, GL_POINTS, m_ca.m_n_points);
     glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
     glDrawArrays(GL_POINTS, m_ca.m_n_points, m_ca.m_n_points_selection_invisible);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
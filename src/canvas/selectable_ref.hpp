@@ -36,3 +36,12 @@ public:
     friend bool operator==(const SelectableRef &, const SelectableRef &) = default;
 };
 } // namespace dune3d
+
+namespace std {
+template <> struct hash<dune3d::SelectableRef> {
+    std::size_t operator()(const dune3d::SelectableRef &k) const
+    {
+        return k.item.hash() ^ (static_cast<size_t>(k.point) * 31 + static_cast<size_t>(k.type));
+    }
+};
+} // namespace std
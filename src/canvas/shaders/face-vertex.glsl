@@ -25,7 +25,7 @@ void main()
     if(!isnan(override_color.r))
         color_to_fragment = override_color;
     vec4 p4 = vec4(position*normal_mat + origin, 1);
-    vec4 n4 = vec4(normal, 0);
+    vec4 n4 = vec4(normal*normal_mat, 0);
 
     gl_Position = (proj * view) * p4;
     pos_to_fragment = p4.xyz;
@@ -15,9 +15,12 @@ uniform uint pick_base;
 
 uniform mat4 view;
 uniform mat4 proj;
+
+##ubo
+
 void main() {
 	pick_to_geom = uint(gl_VertexID+int(pick_base));
-	flags_to_geom = flags;
+	flags_to_geom = add_pick_flags(flags, pick_to_geom, gl_VertexID);
     origin_to_geom = (proj*view*vec4(origin, 1));
     right_to_geom = (proj*view*vec4(right, 0));
     up_to_geom = (proj*view*vec4(up, 0));
@@ -16,9 +16,12 @@ uniform uint pick_base;
 uniform mat4 view;
 uniform mat4 proj;
 uniform float scale_factor;
+
+##ubo
+
 void main() {
 	pick_to_geom = uint(gl_VertexID+int(pick_base));
-	flags_to_geom = flags;
+	flags_to_geom = add_pick_flags(flags, pick_to_geom, gl_VertexID);
     origin_to_geom = (proj*view*vec4(origin, 1));
     shift_to_geom = shift * scale_factor;
     bits_to_geom = bits;
@@ -20,9 +20,11 @@ uniform mat4 view;
 uniform mat4 proj;
 uniform mat3 screen;
 
+##ubo
+
 void main() {
 	pick_to_geom = uint(gl_VertexID+int(pick_base));
-	flags_to_geom = flags;
+	flags_to_geom = add_pick_flags(flags, pick_to_geom, gl_VertexID);
     origin_to_geom = (proj*view*vec4(origin, 1));
     vec3 t = screen*vec3(1,-1,0);
     if(!isnan(vec.x)) {
@@ -17,7 +17,7 @@ uniform float screen_scale;
 
 void main() {
 	pick_to_geom = uint(gl_VertexID+int(pick_base));
-	flags_to_geom = flags;
+	flags_to_geom = add_pick_flags(flags, pick_to_geom, gl_VertexID);
 	if(FLAG_IS_SET(flags, VERTEX_FLAG_SCREEN)) { //screen
 		p1_to_geom = (proj*view*vec4(p1, 1));
 		p1_to_geom /= p1_to_geom.w;
@@ -14,10 +14,11 @@ flat out float select_alpha_to_frag;
 ##ubo
 
 void main() {
-  color_to_frag = get_color(flags);
-  depth_shift_to_frag = get_depth_shift(flags);
-  select_alpha_to_frag = get_select_alpha(flags);
+  pick_to_frag = uint(gl_VertexID+int(pick_base));
+  uint vflags = add_pick_flags(flags, pick_to_frag, gl_VertexID);
+  color_to_frag = get_color(vflags);
+  depth_shift_to_frag = get_depth_shift(vflags);
+  select_alpha_to_frag = get_select_alpha(vflags);
   
   gl_Position = proj*view*(vec4(position, 1) + vec4(0,0,z_offset, 0));
-  pick_to_frag = uint(gl_VertexID+int(pick_base));
 }
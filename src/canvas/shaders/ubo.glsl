@@ -37,6 +37,19 @@ float get_select_alpha(uint flags)
         return 0.;
 }
 
+// selection, hover and highlight, see Canvas::push_pick_flags
+uniform usamplerBuffer pick_flags;
+uniform uint pick_count;
+
+uint add_pick_flags(uint flags, uint pick, int vertex_id)
+{
+    // selection invisible vertices come after the pickable ones and don't have any
+    if(uint(vertex_id) >= pick_count)
+        return flags;
+    // pick 0 is the background
+    return flags | texelFetch(pick_flags, int(pick) - 1).r;
+}
+
 bool test_peel(uint pick)
 {
     for(int i = 0; i < peeled_picks.length(); i++)
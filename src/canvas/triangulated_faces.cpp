@@ -0,0 +1,110 @@
+#include "triangulated_faces.hpp"
+#include "vertex_welder.hpp"
+#include <Standard_Version.hxx>
+#include <TShort_Array1OfShortReal.hxx>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+#if OCC_VERSION_MAJOR >= 7 && OCC_VERSION_MINOR >= 6
+#define HORIZON_NEW_OCC
+#endif
+
+namespace dune3d {
+
+static constexpr float s_weld_tolerance = 1e-5;
+
+static void convert_face(const TriangulatedFace &face, face::Face &face_out)
+{
+    const auto &triangulation = face.triangulation;
+    const auto &mat = face.mat;
+
+#ifndef HORIZON_NEW_OCC
+    const TColgp_Array1OfPnt &arrPolyNodes = triangulation->Nodes();
+    const Poly_Array1OfTriangle &arrTriangles = triangulation->Triangles();
+    const TShort_Array1OfShortReal &arrNormals = triangulation->Normals();
+#endif
+
+    face_out.color = face.color;
+
+    // coincident vertices, such as the ones along seams, get merged into one with an averaged normal
+    face::VertexWelder welder{s_weld_tolerance};
+    welder.reserve(triangulation->NbNodes());
+    std::vector<size_t> indices;
+    indices.reserve(triangulation->NbNodes());
+    for (int i = 1; i <= triangulation->NbNodes(); i++) {
+#ifdef HORIZON_NEW_OCC
+        gp_XYZ v(triangulation->Node(i).Coord());
+        const auto n = triangulation->Normal(i);
+        const glm::vec4 ng(n.X(), n.Y(), n.Z(), 0);
+#else
+        gp_XYZ v(arrPolyNodes(i).Coord());
+        auto offset = (i - 1) * 3 + 1;
+        const glm::vec4 ng(arrNormals(offset + 0), arrNormals(offset + 1), arrNormals(offset + 2), 0);
+#endif
+        const glm::vec4 vg(v.X(), v.Y(), v.Z(), 1);
+        const auto vt = mat * vg;
+        auto nt = mat * ng;
+        nt /= nt.length();
+        indices.push_back(welder.add(face::Vertex(vt.x, vt.y, vt.z), face::Vertex(nt.x, nt.y, nt.z)));
+    }
+    welder.get(face_out);
+
+    face_out.triangle_indices.reserve(triangulation->NbTriangles());
+    for (int i = 1; i <= triangulation->NbTriangles(); i++) {
+        int a, b, c;
+#ifdef HORIZON_NEW_OCC
+        triangulation->Triangle(i).Get(a, b, c);
+#else
+        arrTriangles(i).Get(a, b, c);
+#endif
+        const auto ia = indices.at(a - 1);
+        const auto ib = indices.at(b - 1);
+        const auto ic = indices.at(c - 1);
+        // collapsed by welding
+        if (ia == ib || ib == ic || ia == ic)
+            continue;
+        face_out.triangle_indices.emplace_back(ia, ib, ic);
+    }
+}
+
+// threads besides the calling ones converting faces, shared among all calls
+// as solid models of several groups may be triangulated at the same time
+static std::atomic_uint s_n_helper_threads = 0;
+
+static unsigned int acquire_helper_threads(unsigned int wanted)
+{
+    const unsigned int max_threads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    auto n = s_n_helper_threads.load();
+    unsigned int acquired;
+    do {
+        acquired = std::min(wanted, max_threads - std::min(n, max_threads));
+    } while (!s_n_helper_threads.compare_exchange_weak(n, n + acquired));
+    return acquired;
+}
+
+void convert_triangulated_faces(const std::vector<TriangulatedFace> &faces, face::Faces &faces_out)
+{
+    // each face is converted into its own slot, so the result doesn't depend on scheduling
+    std::vector<face::Face> converted(faces.size());
+    std::atomic_size_t next = 0;
+    auto worker = [&faces, &converted, &next] {
+        for (size_t i = next++; i < faces.size(); i = next++)
+            convert_face(faces.at(i), converted.at(i));
+    };
+
+    // not worth spawning threads for a handful of faces
+    const auto n_helpers = acquire_helper_threads(faces.size() / 16);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < n_helpers; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+    s_n_helper_threads -= n_helpers;
+
+    std::ranges::move(converted, std::back_inserter(faces_out));
+}
+
+} // namespace dune3d
@@ -0,0 +1,22 @@
+#pragma once
+#include "face.hpp"
+#include <Poly_Triangulation.hxx>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace dune3d {
+
+// A face that has been meshed by OCC, but not yet converted to a face::Face
+class TriangulatedFace {
+public:
+    Handle(Poly_Triangulation) triangulation;
+    glm::dmat4 mat;
+    face::Color color;
+};
+
+// Converts the faces using the cores that aren't busy converting other faces,
+// appending them to faces_out in order.
+// The triangulations need to have their normals computed already.
+void convert_triangulated_faces(const std::vector<TriangulatedFace> &faces, face::Faces &faces_out);
+
+} // namespace dune3d
@@ -0,0 +1,75 @@
+#include "vertex_welder.hpp"
+#include <cmath>
+
+namespace dune3d::face {
+
+VertexWelder::VertexWelder(float tolerance) : m_tolerance(tolerance), m_cell_size(tolerance * 2)
+{
+}
+
+void VertexWelder::reserve(size_t n)
+{
+    m_cells.reserve(n);
+    m_vertices.reserve(n);
+    m_normals.reserve(n);
+    m_counts.reserve(n);
+}
+
+size_t VertexWelder::add(const Vertex &v, const Vertex &n)
+{
+    // cells that may contain vertices within the tolerance, along each axis
+    std::array<std::array<int64_t, 2>, 3> ranges;
+    const std::array<float, 3> coords = {v.x, v.y, v.z};
+    for (size_t i = 0; i < 3; i++) {
+        ranges[i] = {static_cast<int64_t>(std::floor((coords[i] - m_tolerance) / m_cell_size)),
+                     static_cast<int64_t>(std::floor((coords[i] + m_tolerance) / m_cell_size))};
+    }
+
+    const float tol2 = m_tolerance * m_tolerance;
+    for (auto x = ranges[0][0]; x <= ranges[0][1]; x++) {
+        for (auto y = ranges[1][0]; y <= ranges[1][1]; y++) {
+            for (auto z = ranges[2][0]; z <= ranges[2][1]; z++) {
+                auto it = m_cells.find({x, y, z});
+                if (it == m_cells.end())
+                    continue;
+                for (const auto idx : it->second) {
+                    const auto &o = m_vertices.at(idx);
+                    const float dx = o.x - v.x;
+                    const float dy = o.y - v.y;
+                    const float dz = o.z - v.z;
+                    if (dx * dx + dy * dy + dz * dz <= tol2) {
+                        m_normals.at(idx) += n;
+                        m_counts.at(idx)++;
+                        return idx;
+                    }
+                }
+            }
+        }
+    }
+
+    const auto idx = m_vertices.size();
+    m_vertices.push_back(v);
+    m_normals.push_back(n);
+    m_counts.push_back(1);
+    const Cell cell = {static_cast<int64_t>(std::floor(v.x / m_cell_size)),
+                       static_cast<int64_t>(std::floor(v.y / m_cell_size)),
+                       static_cast<int64_t>(std::floor(v.z / m_cell_size))};
+    m_cells[cell].push_back(idx);
+    return idx;
+}
+
+void VertexWelder::get(Face &face)
+{
+    for (size_t i = 0; i < m_normals.size(); i++) {
+        if (m_counts.at(i) > 1)
+            m_normals.at(i) /= m_counts.at(i);
+    }
+    face.vertices = std::move(m_vertices);
+    face.normals = std::move(m_normals);
+    m_vertices.clear();
+    m_normals.clear();
+    m_counts.clear();
+    m_cells.clear();
+}
+
+} // namespace dune3d::face
@@ -0,0 +1,44 @@
+#pragma once
+#include "face.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace dune3d::face {
+
+// Merges vertices that are closer than the tolerance to each other, averaging
+// their normals. Vertices get sorted into a grid of cells twice the tolerance
+// in size, so finding the ones close to a new vertex only needs to look at the
+// up to eight cells around it.
+class VertexWelder {
+public:
+    explicit VertexWelder(float tolerance);
+
+    // returns the index of the vertex v ended up as
+    size_t add(const Vertex &v, const Vertex &n);
+
+    void reserve(size_t n);
+
+    // moves the merged vertices and averaged normals into face
+    void get(Face &face);
+
+private:
+    const float m_tolerance;
+    const float m_cell_size;
+
+    using Cell = std::array<int64_t, 3>;
+    struct CellHash {
+        size_t operator()(const Cell &c) const
+        {
+            return (c[0] * 73856093) ^ (c[1] * 19349663) ^ (c[2] * 83492791);
+        }
+    };
+    std::unordered_map<Cell, std::vector<size_t>, CellHash> m_cells;
+
+    std::vector<Vertex> m_vertices;
+    std::vector<Vertex> m_normals;
+    std::vector<unsigned int> m_counts;
+};
+
+} // namespace dune3d::face
@@ -4,19 +4,24 @@
 #include "nlohmann/json.hpp"
 #include "tool_id.hpp"
 #include "document/document.hpp"
+#include "document/document_loader.hpp"
 #include "document/group/group.hpp"
 #include "document/group/group_extrude.hpp"
+#include "document/group/igroup_solid_model.hpp"
 #include "document/entity/entity_workplane.hpp"
 #include "document/entity/entity_document.hpp"
 #include "system/system.hpp"
 #include "util/fs_util.hpp"
 #include "logger/log_util.hpp"
+#include "preferences/preferences.hpp"
+#include <glibmm/fileutils.h>
 #include <iostream>
 
 namespace dune3d {
 
 Core::Core(EditorInterface &intf) : m_intf(intf)
 {
+    m_solid_model_worker.signal_done().connect(sigc::mem_fun(*this, &Core::apply_solid_models));
 }
 
 Core::~Core() = default;
@@ -53,6 +58,7 @@ UUID Core::add_document(const std::filesystem::path &path, const UUID &uu)
     m_documents.emplace(std::piecewise_construct, std::forward_as_tuple(uu), std::forward_as_tuple(uu, path));
     if (m_documents.size() == 1)
         m_current_document = uu;
+    update_solid_models_in_background(uu);
 
     update_can_close();
     m_signal_documents_changed.emit();
@@ -63,6 +69,7 @@ void Core::close_document(const UUID &uu)
 {
     if (!m_documents.at(uu).m_can_close)
         return;
+    m_solid_model_worker.cancel(uu);
     m_documents.erase(uu);
     if (m_current_document == uu && m_documents.size()) {
         m_current_document = m_documents.begin()->first;
@@ -105,6 +112,7 @@ void Core::undo()
     if (get_current_document_info().undo()) {
         fix_current_group();
         update_can_close();
+        update_solid_models_in_background();
         m_signal_rebuilt.emit();
         m_signal_needs_save.emit();
     }
@@ -117,6 +125,7 @@ void Core::redo()
     if (get_current_document_info().redo()) {
         fix_current_group();
         update_can_close();
+        update_solid_models_in_background();
         m_signal_rebuilt.emit();
         m_signal_needs_save.emit();
     }
@@ -137,15 +146,17 @@ bool Core::can_redo() const
 }
 
 
-Core::DocumentInfo::DocumentInfo(const UUID &uu) : m_uuid(uu)
+Core::DocumentInfo::DocumentInfo(const UUID &uu) : m_uuid(uu), m_binary(Preferences::get().document.binary_format)
 {
     m_doc.emplace();
+    m_doc->set_solid_model_update_deferred(true);
     history_push("init");
     m_current_group = m_doc->get_groups_sorted().back()->m_uuid;
 }
 
 Core::DocumentInfo::DocumentInfo(const UUID &uu, const std::filesystem::path &path)
-    : m_uuid(uu), m_path(path), m_doc(Document::new_from_file(path))
+    : m_uuid(uu), m_path(path), m_doc(Document::new_from_file(path, Document::SolidModelUpdate::DEFERRED)),
+      m_binary(DocumentLoader::is_binary(path))
 {
     history_push("init");
     m_current_group = m_doc->get_groups_sorted().back()->m_uuid;
@@ -154,27 +165,51 @@ Core::DocumentInfo::DocumentInfo(const UUID &uu, const std::filesystem::path &pa
 
 class HistoryItemDocument : public HistoryManager::HistoryItem {
 public:
-    HistoryItemDocument(const Document &doc, const std::string &cm) : HistoryManager::HistoryItem(cm), document(doc)
+    HistoryItemDocument(std::unique_ptr<Document::Snapshot> snap, const std::string &cm)
+        : HistoryManager::HistoryItem(cm), snapshot(std::move(snap))
     {
     }
-    Document document;
+    // solid models may only become available after the item has been pushed
+    std::unique_ptr<Document::Snapshot> snapshot;
 };
 
+static Document::Snapshot &get_snapshot(const HistoryManager::HistoryItem &it)
+{
+    return *dynamic_cast<const HistoryItemDocument &>(it).snapshot;
+}
+
 const Document &Core::DocumentInfo::get_last_document() const
 {
-    return dynamic_cast<const HistoryItemDocument &>(m_history_manager.get_current()).document;
+    if (!m_last_doc)
+        m_last_doc.emplace(get_snapshot(m_history_manager.get_current()));
+    return m_last_doc.value();
+}
+
+void Core::DocumentInfo::copy_solid_models_from(const Document &doc)
+{
+    if (&doc != &m_doc.value())
+        m_doc->copy_solid_models_from(doc);
+    // the current history item is what the document has been pushed to or loaded from
+    get_snapshot(m_history_manager.get_current()).copy_solid_models_from(doc);
+    if (m_last_doc)
+        m_last_doc->copy_solid_models_from(doc);
 }
 
 void Core::DocumentInfo::history_push(const std::string &comment)
 {
-    m_history_manager.push(std::make_unique<HistoryItemDocument>(m_doc.value(), comment));
+    // the document is in sync with the current history item, so unchanged items can be shared with it
+    const Document::Snapshot *previous = nullptr;
+    if (m_history_manager.has_current())
+        previous = &get_snapshot(m_history_manager.get_current());
+    m_history_manager.push(std::make_unique<HistoryItemDocument>(m_doc->make_snapshot(previous), comment));
+    m_last_doc.reset();
 }
 
 void Core::DocumentInfo::history_load(const HistoryManager::HistoryItem &it)
 {
-    auto &itd = dynamic_cast<const HistoryItemDocument &>(it);
     m_doc.reset();
-    m_doc.emplace(itd.document);
+    m_doc.emplace(get_snapshot(it));
+    m_last_doc.reset();
     m_needs_save = true;
 }
 
@@ -208,7 +243,13 @@ void Core::DocumentInfo::save()
         return;
     if (has_path()) {
         m_doc->m_version.update_file_from_app();
-        save_json_to_file(m_path, m_doc->serialize());
+        if (m_binary) {
+            const auto bs = json::to_cbor(m_doc->serialize());
+            Glib::file_set_contents(m_path.string(), reinterpret_cast<const gchar *>(bs.data()), bs.size());
+        }
+        else {
+            save_json_to_file(m_path, m_doc->serialize());
+        }
         m_needs_save = false;
     }
 }
@@ -308,6 +349,7 @@ void Core::solve_current(const DraggedList &dragged)
     if (!tool_is_active())
         throw std::runtime_error("to be called in tools only");
     auto &doc = get_current_document();
+    m_solid_model_worker.cancel(m_current_document);
     doc.update_pending(get_current_group(), dragged);
 }
 
@@ -528,7 +570,8 @@ bool Core::maybe_end_tool(const ToolResponse &r)
             rebuild_internal(true, "undo");
         }
         else if (r.result == ToolResponse::Result::END) { // did nothing
-            // do nothing
+            // solid models that got updated while the tool was active have been ignored
+            update_solid_models_in_background();
         }
         // tool_id_current = ToolID::NONE;
         return true;
@@ -602,9 +645,66 @@ void Core::rebuild_finish(bool from_undo, const std::string &comment)
     if (!from_undo) {
         m_documents.at(m_current_document).history_push(comment);
     }
+    update_solid_models_in_background();
     m_signal_rebuilt.emit();
 }
 
+void Core::update_solid_models_in_background()
+{
+    if (!has_documents())
+        return;
+    update_solid_models_in_background(m_current_document);
+}
+
+void Core::update_solid_models_in_background(const UUID &doc_uu)
+{
+    const auto &doc = m_documents.at(doc_uu).get_document();
+    if (doc.get_solid_model_update_pending())
+        m_solid_model_worker.submit(doc_uu, doc, m_solid_model_settings);
+}
+
+void Core::set_solid_model_settings(const SolidModelSettings &settings)
+{
+    const bool affects_solid_models = settings.affects_solid_models(m_solid_model_settings);
+    m_solid_model_settings = settings;
+    if (!affects_solid_models)
+        return;
+    for (auto &[uu, docinf] : m_documents) {
+        auto &doc = docinf.get_document();
+        for (const auto &[group_uu, group] : doc.get_groups()) {
+            if (dynamic_cast<const IGroupSolidModel *>(group.get()))
+                doc.set_group_update_solid_model_pending(group_uu);
+        }
+        // the tool's document gets updated once the tool is done
+        if (!tool_is_active() || uu != m_current_document)
+            update_solid_models_in_background(uu);
+    }
+}
+
+void Core::apply_solid_models(const UUID &doc_uu, const Document &doc)
+{
+    // the tool may have changed its document, it'll get updated again once the tool is done
+    if (tool_is_active() && doc_uu == m_current_document)
+        return;
+    if (!m_documents.contains(doc_uu))
+        return;
+    m_documents.at(doc_uu).copy_solid_models_from(doc);
+    m_signal_solid_models_updated.emit();
+}
+
+void Core::update_solid_models_now()
+{
+    if (!has_documents())
+        return;
+    auto &doc = get_current_document();
+    if (!doc.get_solid_model_update_pending())
+        return;
+    m_solid_model_worker.cancel(m_current_document);
+    doc.update_solid_models(m_solid_model_settings, [] { return false; });
+    get_current_document_info().copy_solid_models_from(doc);
+    m_signal_solid_models_updated.emit();
+}
+
 std::optional<ToolArgs> Core::get_pending_tool_args()
 {
     if (m_tool_state != ToolState::NONE)
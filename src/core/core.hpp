@@ -8,6 +8,7 @@
 #include "tool.hpp"
 #include "idocument_info.hpp"
 #include "idocument_provider.hpp"
+#include "solid_model_worker.hpp"
 
 namespace dune3d {
 
@@ -52,6 +53,12 @@ public:
         return m_signal_needs_save;
     }
 
+    using type_signal_solid_models_updated = sigc::signal<void()>;
+    type_signal_solid_models_updated signal_solid_models_updated()
+    {
+        return m_signal_solid_models_updated;
+    }
+
     ToolResponse tool_begin(ToolID tool_id, const ToolArgs &args, bool transient = false);
     ToolResponse tool_update(ToolArgs &args);
 
@@ -88,6 +95,13 @@ public:
 
     void rebuild(const std::string &comment);
 
+    // Solid models get updated in the background after rebuilding. This updates the
+    // current document's ones right away for things that need them to be up to date.
+    void update_solid_models_now();
+
+    // Solid models of all documents get rebuilt if the new settings may change them
+    void set_solid_model_settings(const SolidModelSettings &settings);
+
     void undo();
     void redo();
 
@@ -177,6 +191,7 @@ private:
         }
 
         const Document &get_last_document() const;
+        void copy_solid_models_from(const Document &doc);
         std::string get_basename() const override;
         std::filesystem::path get_dirname() const override;
         std::filesystem::path get_path() const override;
@@ -201,11 +216,17 @@ private:
 
         std::filesystem::path m_path;
         std::optional<Document> m_doc;
+        // documents are saved in the format they've been loaded from
+        bool m_binary = false;
         bool m_needs_save = false;
         UUID m_current_group;
         bool m_from_entity = false;
         bool m_can_close = true;
         HistoryManager m_history_manager;
+
+    private:
+        // the current history item as a document, only created when needed
+        mutable std::optional<Document> m_last_doc;
     };
 
     DocumentInfo &get_current_document_info()
@@ -226,6 +247,14 @@ private:
     type_signal_tool_changed m_signal_tool_changed;
     type_signal_rebuilt m_signal_rebuilt;
     type_signal_needs_save m_signal_needs_save;
+    type_signal_solid_models_updated m_signal_solid_models_updated;
+
+    SolidModelWorker m_solid_model_worker;
+    // only accessed from the main thread, solid models get updated with a copy of them
+    SolidModelSettings m_solid_model_settings;
+    void update_solid_models_in_background();
+    void update_solid_models_in_background(const UUID &doc_uu);
+    void apply_solid_models(const UUID &doc_uu, const Document &doc);
 
     void rebuild_internal(bool from_undo, const std::string &comment);
     void rebuild_finish(bool from_undo, const std::string &comment);
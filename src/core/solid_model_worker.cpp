@@ -0,0 +1,85 @@
+#include "solid_model_worker.hpp"
+#include "document/document.hpp"
+#include <optional>
+
+namespace dune3d {
+
+SolidModelWorker::SolidModelWorker()
+{
+    m_dispatcher.connect([this] {
+        std::list<Job> results;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            std::swap(results, m_results);
+        }
+        for (const auto &result : results) {
+            if (!is_stale(result))
+                m_signal_done.emit(result.doc_uu, *result.doc);
+        }
+    });
+    m_thread = std::thread(&SolidModelWorker::worker_thread, this);
+}
+
+void SolidModelWorker::submit(const UUID &doc_uu, const Document &doc, const SolidModelSettings &settings)
+{
+    auto copy = std::make_unique<Document>(doc);
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        const auto serial = ++m_serial;
+        m_serials.insert_or_assign(doc_uu, serial);
+        m_jobs.insert_or_assign(doc_uu, Job{serial, doc_uu, std::move(copy), settings});
+    }
+    m_cond.notify_one();
+}
+
+void SolidModelWorker::cancel(const UUID &doc_uu)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_serials.erase(doc_uu);
+    m_jobs.erase(doc_uu);
+}
+
+bool SolidModelWorker::is_stale(const Job &job)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_exit)
+        return true;
+    auto it = m_serials.find(job.doc_uu);
+    return it == m_serials.end() || it->second != job.serial;
+}
+
+void SolidModelWorker::worker_thread()
+{
+    while (true) {
+        std::optional<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_exit || m_jobs.size(); });
+            if (m_exit)
+                return;
+            auto node = m_jobs.extract(m_jobs.begin());
+            job.emplace(std::move(node.mapped()));
+        }
+
+        if (!job->doc->update_solid_models(job->settings, [this, &job] { return is_stale(*job); }))
+            continue;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_results.push_back(std::move(*job));
+        }
+        m_dispatcher.emit();
+    }
+}
+
+SolidModelWorker::~SolidModelWorker()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_exit = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+} // namespace dune3d
@@ -0,0 +1,65 @@
+#pragma once
+#include "util/uuid.hpp"
+#include "document/solid_model_settings.hpp"
+#include <glibmm/dispatcher.h>
+#include <sigc++/sigc++.h>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace dune3d {
+
+class Document;
+
+// Updates solid models on a copy of a document in a background thread, so
+// that slow OpenCASCADE operations don't block the UI. Documents get updated
+// one after the other.
+class SolidModelWorker {
+public:
+    SolidModelWorker();
+
+    // Replaces the document's job that's currently queued or running, if any.
+    void submit(const UUID &doc_uu, const Document &doc, const SolidModelSettings &settings);
+    void cancel(const UUID &doc_uu);
+
+    // Emitted on the main thread with the updated copy of the document unless
+    // another job for it has been submitted or cancel got called in the meantime.
+    using type_signal_done = sigc::signal<void(const UUID &doc_uu, const Document &doc)>;
+    type_signal_done signal_done()
+    {
+        return m_signal_done;
+    }
+
+    ~SolidModelWorker();
+
+private:
+    struct Job {
+        unsigned int serial;
+        UUID doc_uu;
+        std::unique_ptr<Document> doc;
+        SolidModelSettings settings;
+    };
+
+    void worker_thread();
+    bool is_stale(const Job &job);
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::map<UUID, Job> m_jobs;
+    std::list<Job> m_results;
+    bool m_exit = false;
+
+    // serial of each document's latest job, so that running jobs know when
+    // they're stale, cancel removes the document
+    std::map<UUID, unsigned int> m_serials;
+    unsigned int m_serial = 0;
+
+    Glib::Dispatcher m_dispatcher;
+    type_signal_done m_signal_done;
+    std::thread m_thread;
+};
+
+} // namespace dune3d
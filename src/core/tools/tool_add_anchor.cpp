@@ -13,7 +13,13 @@ namespace dune3d {
 
 ToolBase::CanBegin ToolAddAnchor::can_begin()
 {
-    return entity_and_point_from_selection(get_doc(), m_selection, Entity::Type::STEP).has_value();
+    auto enp = entity_and_point_from_selection(get_doc(), m_selection, Entity::Type::STEP);
+    if (!enp)
+        return false;
+    auto &en = get_entity<EntitySTEP>(enp->entity);
+
+    // the points to anchor to aren't known until the import has finished
+    return en.m_imported && en.m_imported->ready;
 }
 
 ToolResponse ToolAddAnchor::begin(const ToolArgs &args)
@@ -22,6 +28,7 @@ ToolResponse ToolAddAnchor::begin(const ToolArgs &args)
 
     m_step = &m_core.get_current_document().get_entity<EntitySTEP>(sr.item);
     m_step->m_show_points = true;
+    get_doc().set_group_changed(m_step->m_group);
 
     m_selection.clear();
     m_intf.enable_hover_selection();
@@ -201,7 +201,7 @@ Constraint *ToolDrawContour::constrain_point_and_add_head_tangent_constraint(con
                 if (!redundant_before) {
                     const auto redundant_after = current_group_has_redundant_constraints();
                     if (redundant_after) {
-                        get_doc().m_constraints.erase(new_constraint->m_uuid);
+                        get_doc().erase_constraint(new_constraint->m_uuid);
                         new_constraint = nullptr;
                     }
                 }
@@ -385,7 +385,7 @@ ToolResponse ToolDrawContour::update(const ToolArgs &args)
                 if (!redundant_before) {
                     const auto redundant_after = current_group_has_redundant_constraints();
                     if (redundant_after) {
-                        get_doc().m_constraints.erase(constraint->m_uuid);
+                        get_doc().erase_constraint(constraint->m_uuid);
                         constraint = nullptr;
                     }
                 }
@@ -520,7 +520,7 @@ ToolResponse ToolDrawContour::update(const ToolArgs &args)
                             constraint->replace_point({m_temp_line->m_uuid, pt}, {m_temp_arc->m_uuid, arc_pt});
                         }
                     }
-                    get_doc().m_entities.erase(m_temp_line->m_uuid);
+                    get_doc().erase_entity(m_temp_line->m_uuid);
                     m_temp_line = nullptr;
                     m_entities.back() = m_temp_arc;
                 }
@@ -539,7 +539,7 @@ ToolResponse ToolDrawContour::update(const ToolArgs &args)
                             constraint->replace_point({m_temp_arc->m_uuid, arc_pt}, {m_temp_line->m_uuid, pt});
                         }
                     }
-                    get_doc().m_entities.erase(m_temp_arc->m_uuid);
+                    get_doc().erase_entity(m_temp_arc->m_uuid);
                     m_temp_arc = nullptr;
                     m_entities.back() = m_temp_line;
                 }
@@ -601,9 +601,9 @@ ToolResponse ToolDrawContour::end_tool()
         for (auto constraint : m_constraints) {
             auto ents = constraint->get_referenced_entities();
             if (ents.contains(t->m_uuid))
-                get_doc().m_constraints.erase(constraint->m_uuid);
+                get_doc().erase_constraint(constraint->m_uuid);
         }
-        get_doc().m_entities.erase(t->m_uuid);
+        get_doc().erase_entity(t->m_uuid);
         return ToolResponse::commit();
     }
     else {
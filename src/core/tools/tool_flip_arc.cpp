@@ -23,11 +23,14 @@ ToolResponse ToolFlipArc::begin(const ToolArgs &args)
 
     auto &arc = get_entity<EntityArc2D>(enp->entity);
     std::swap(arc.m_from, arc.m_to);
+    get_doc().set_group_changed(arc.m_group);
 
     for (auto &[uu, constraint] : get_doc().m_constraints) {
-        constraint->replace_point({arc.m_uuid, 1}, {arc.m_uuid, 11});
-        constraint->replace_point({arc.m_uuid, 2}, {arc.m_uuid, 1});
-        constraint->replace_point({arc.m_uuid, 11}, {arc.m_uuid, 2});
+        bool replaced = constraint->replace_point({arc.m_uuid, 1}, {arc.m_uuid, 11});
+        replaced = constraint->replace_point({arc.m_uuid, 2}, {arc.m_uuid, 1}) || replaced;
+        replaced = constraint->replace_point({arc.m_uuid, 11}, {arc.m_uuid, 2}) || replaced;
+        if (replaced)
+            get_doc().set_group_changed(constraint->m_group);
     }
 
     return ToolResponse::commit();
@@ -47,18 +47,17 @@ ToolResponse ToolMove::begin(const ToolArgs &args)
             m_inital_pos_wrkpl.emplace(uu, wrkpl.project(get_cursor_pos_for_workplane(wrkpl)));
         }
     }
-    const Group *first_group = nullptr;
     for (const auto &sr : m_selection) {
         if (sr.type == SelectableRef::Type::ENTITY) {
             auto &entity = get_entity(sr.item);
             if (entity.m_move_instead.contains(sr.point)) {
                 auto &enp = entity.m_move_instead.at(sr.point);
                 auto &other_entity = get_entity(enp.entity);
-                get_doc().accumulate_first_group(first_group, other_entity.m_group);
+                m_groups.insert(other_entity.m_group);
                 m_entities.emplace(&other_entity, enp.point);
             }
             else {
-                get_doc().accumulate_first_group(first_group, entity.m_group);
+                m_groups.insert(entity.m_group);
                 m_entities.emplace(&entity, sr.point);
             }
         }
@@ -73,9 +72,6 @@ ToolResponse ToolMove::begin(const ToolArgs &args)
         }
         // we don't care about constraints since dragging them is pureley cosmetic
     }
-    if (first_group)
-        m_first_group = first_group->m_uuid;
-
 
     for (auto [entity, point] : m_entities) {
         m_dragged_list.emplace_back(entity->m_uuid, point);
@@ -193,7 +189,9 @@ ToolResponse ToolMove::update(const ToolArgs &args)
             }
         }
 
-        doc.set_group_solve_pending(m_first_group);
+        for (const auto &uu : m_groups) {
+            doc.set_group_solve_pending(uu);
+        }
         m_core.solve_current(m_dragged_list);
 
         for (auto sr : m_selection) {
@@ -202,6 +200,7 @@ ToolResponse ToolMove::update(const ToolArgs &args)
                 auto co_wrkpl = dynamic_cast<const IConstraintWorkplane *>(constraint);
                 auto co_movable = dynamic_cast<IConstraintMovable *>(constraint);
                 if (co_movable) {
+                    doc.set_group_changed(constraint->m_group);
                     auto cdelta = delta;
                     glm::dvec2 delta2d;
                     if (co_wrkpl) {
@@ -1,6 +1,7 @@
 #include "tool_common.hpp"
 #include "in_tool_action/in_tool_action.hpp"
 #include <map>
+#include <set>
 
 namespace dune3d {
 
@@ -37,7 +38,7 @@ private:
     glm::dvec3 m_inital_pos;
     std::map<UUID, glm::dvec2> m_inital_pos_wrkpl;
     std::map<UUID, glm::dvec3> m_inital_pos_angle_constraint;
-    UUID m_first_group;
+    std::set<UUID> m_groups;
     std::set<std::pair<Entity *, unsigned int>> m_entities;
     ICore::DraggedList m_dragged_list;
 };
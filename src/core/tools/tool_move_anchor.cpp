@@ -19,6 +19,9 @@ ToolBase::CanBegin ToolMoveAnchor::can_begin()
         return false;
     auto &en = get_entity<EntitySTEP>(enp->entity);
 
+    if (!en.m_imported || !en.m_imported->ready)
+        return false;
+
     return en.m_anchors.contains(enp->point);
 }
 
@@ -31,6 +34,7 @@ ToolResponse ToolMoveAnchor::begin(const ToolArgs &args)
     m_step = &m_core.get_current_document().get_entity<EntitySTEP>(enp->entity);
     m_anchor = enp->point;
     m_step->m_show_points = true;
+    get_doc().set_group_changed(m_step->m_group);
 
 
     m_selection.clear();
@@ -10,12 +10,18 @@
 #include "group/group_reference.hpp"
 #include "group/group_sketch.hpp"
 #include "system/system.hpp"
+#include "solid_model_cache.hpp"
+#include "document_loader.hpp"
 #include "logger/logger.hpp"
 #include "logger/log_util.hpp"
 #include <ranges>
 #include <set>
 #include <algorithm>
 #include <iostream>
+#include <future>
+#include <chrono>
+#include <format>
+#include <atomic>
 #include <glibmm.h>
 #include "util/template_util.hpp"
 #include "entity/entity_and_point.hpp"
@@ -88,8 +94,22 @@ Document::Document(const json &j, const std::filesystem::path &containing_dir) :
                          std::forward_as_tuple(Group::new_from_json(uu, it)));
     }
 
-    if (m_groups.size())
-        set_group_generate_pending(get_groups_sorted().front()->m_uuid);
+    load_finish();
+}
+
+Document::Document(DocumentLoader &loader, SolidModelUpdate solid_model_update)
+    : m_entities(std::move(loader.m_entities)), m_constraints(std::move(loader.m_constraints)),
+      m_version(app_version, loader.m_header), m_groups(std::move(loader.m_groups)),
+      m_solid_model_update_deferred(solid_model_update == SolidModelUpdate::DEFERRED)
+{
+    load_finish();
+}
+
+void Document::load_finish()
+{
+    for (const auto &[uu, group] : m_groups) {
+        set_group_generate_pending(uu);
+    }
     update_pending();
 
     erase_invalid();
@@ -97,10 +117,130 @@ Document::Document(const json &j, const std::filesystem::path &containing_dir) :
 
 void Document::erase_invalid()
 {
+    const auto n_constraints = m_constraints.size();
     map_erase_if(m_constraints, [this](auto &x) { return !x.second->is_valid(*this); });
+    if (m_constraints.size() != n_constraints)
+        m_index.invalidate();
+}
+
+void Document::erase_entity(const UUID &uu)
+{
+    auto it = m_entities.find(uu);
+    if (it == m_entities.end())
+        return;
+    if (m_index.valid) {
+        if (auto git = m_index.group_entities.find(it->second->m_group); git != m_index.group_entities.end()) {
+            if (git->second.erase(uu))
+                m_index.n_entities--;
+        }
+    }
+    m_entities.erase(it);
 }
 
-Document::Document(const Document &other) : m_version(other.m_version)
+void Document::erase_constraint(const UUID &uu)
+{
+    auto it = m_constraints.find(uu);
+    if (it == m_constraints.end())
+        return;
+    if (m_index.valid) {
+        if (auto git = m_index.group_constraints.find(it->second->m_group); git != m_index.group_constraints.end()) {
+            if (git->second.erase(uu))
+                m_index.n_constraints--;
+        }
+    }
+    m_index.entity_constraints.reset();
+    m_constraints.erase(it);
+}
+
+void Document::Index::invalidate()
+{
+    valid = false;
+    group_entities.clear();
+    group_constraints.clear();
+    pending_entities.clear();
+    pending_constraints.clear();
+    entity_constraints.reset();
+}
+
+void Document::update_index() const
+{
+    if (m_index.valid) {
+        // an up to date index isn't modified, so lookups can be made from multiple threads
+        if (m_index.pending_entities.size() || m_index.pending_constraints.size()) {
+            for (const auto &uu : m_index.pending_entities) {
+                if (auto it = m_entities.find(uu); it != m_entities.end()) {
+                    if (m_index.group_entities[it->second->m_group].insert(uu).second)
+                        m_index.n_entities++;
+                }
+            }
+            for (const auto &uu : m_index.pending_constraints) {
+                if (auto it = m_constraints.find(uu); it != m_constraints.end()) {
+                    if (m_index.group_constraints[it->second->m_group].insert(uu).second)
+                        m_index.n_constraints++;
+                }
+            }
+            m_index.pending_entities.clear();
+            m_index.pending_constraints.clear();
+        }
+
+        // catches items that have been erased without going through erase_entity/erase_constraint
+        if (m_index.n_entities == m_entities.size() && m_index.n_constraints == m_constraints.size())
+            return;
+    }
+
+    m_index.invalidate();
+    for (const auto &[uu, it] : m_entities) {
+        m_index.group_entities[it->m_group].insert(uu);
+    }
+    for (const auto &[uu, it] : m_constraints) {
+        m_index.group_constraints[it->m_group].insert(uu);
+    }
+    m_index.n_entities = m_entities.size();
+    m_index.n_constraints = m_constraints.size();
+    m_index.valid = true;
+}
+
+static const std::set<UUID> &find_in_index(const std::map<UUID, std::set<UUID>> &index, const UUID &uu)
+{
+    static const std::set<UUID> empty;
+    if (auto it = index.find(uu); it != index.end())
+        return it->second;
+    return empty;
+}
+
+const std::set<UUID> &Document::get_group_entities(const UUID &group) const
+{
+    update_index();
+    return find_in_index(m_index.group_entities, group);
+}
+
+const std::set<UUID> &Document::get_group_constraints(const UUID &group) const
+{
+    update_index();
+    return find_in_index(m_index.group_constraints, group);
+}
+
+const std::set<UUID> &Document::get_entity_constraints(const UUID &entity) const
+{
+    if (!m_index.entity_constraints) {
+        auto &index = m_index.entity_constraints.emplace();
+        for (const auto &[uu, it] : m_constraints) {
+            for (const auto &en : it->get_referenced_entities()) {
+                index[en].insert(uu);
+            }
+        }
+    }
+    return find_in_index(*m_index.entity_constraints, entity);
+}
+
+Document::Document(const Document &other)
+    : m_version(other.m_version), m_groups_generate_pending(other.m_groups_generate_pending),
+      m_groups_solve_pending(other.m_groups_solve_pending),
+      m_groups_update_solid_model_pending(other.m_groups_update_solid_model_pending),
+      m_solid_model_update_deferred(other.m_solid_model_update_deferred),
+      m_solid_model_settings(other.m_solid_model_settings), m_solid_model_keys(other.m_solid_model_keys),
+      m_groups_changed(other.m_groups_changed),
+      m_group_revisions(other.m_group_revisions)
 {
     for (const auto &[uu, it] : other.m_entities) {
         m_entities.emplace(uu, it->clone());
@@ -113,9 +253,85 @@ Document::Document(const Document &other) : m_version(other.m_version)
     }
 }
 
-Document Document::new_from_file(const std::filesystem::path &path)
+Document::Document(const Snapshot &snapshot)
+    : m_version(snapshot.version), m_groups_generate_pending(snapshot.groups_generate_pending),
+      m_groups_solve_pending(snapshot.groups_solve_pending),
+      m_groups_update_solid_model_pending(snapshot.groups_update_solid_model_pending),
+      m_solid_model_update_deferred(snapshot.solid_model_update_deferred),
+      m_solid_model_keys(snapshot.solid_model_keys), m_group_revisions(snapshot.group_revisions)
+{
+    for (const auto &[uu, it] : snapshot.entities) {
+        m_entities.emplace(uu, it->clone());
+    }
+    for (const auto &[uu, it] : snapshot.constraints) {
+        m_constraints.emplace(uu, it->clone());
+    }
+    for (const auto &[uu, it] : snapshot.groups) {
+        m_groups.emplace(uu, it->clone());
+    }
+}
+
+template <typename T>
+static void update_snapshot_items(std::map<UUID, std::shared_ptr<const T>> &items,
+                                  const std::map<UUID, std::unique_ptr<T>> &current,
+                                  const std::map<UUID, std::shared_ptr<const T>> *previous,
+                                  const std::set<UUID> &groups_changed)
+{
+    for (const auto &[uu, it] : current) {
+        if (previous && !groups_changed.contains(it->m_group)) {
+            if (auto prev = previous->find(uu); prev != previous->end()) {
+                items.emplace_hint(items.end(), uu, prev->second);
+                continue;
+            }
+        }
+        items.emplace_hint(items.end(), uu, it->clone());
+    }
+}
+
+std::unique_ptr<Document::Snapshot> Document::make_snapshot(const Snapshot *previous)
+{
+    auto snapshot = std::make_unique<Snapshot>(m_version);
+    update_snapshot_items(snapshot->entities, m_entities, previous ? &previous->entities : nullptr,
+                          m_groups_changed);
+    update_snapshot_items(snapshot->constraints, m_constraints, previous ? &previous->constraints : nullptr,
+                          m_groups_changed);
+    for (const auto &[uu, it] : m_groups) {
+        snapshot->groups.emplace(uu, it->clone());
+    }
+    snapshot->groups_generate_pending = m_groups_generate_pending;
+    snapshot->groups_solve_pending = m_groups_solve_pending;
+    snapshot->groups_update_solid_model_pending = m_groups_update_solid_model_pending;
+    snapshot->solid_model_update_deferred = m_solid_model_update_deferred;
+    snapshot->solid_model_keys = m_solid_model_keys;
+    snapshot->group_revisions = m_group_revisions;
+    m_groups_changed.clear();
+    return snapshot;
+}
+
+Document::Snapshot::Snapshot(const FileVersion &v) : version(v)
+{
+}
+
+Document::Snapshot::~Snapshot() = default;
+
+void Document::Snapshot::copy_solid_models_from(const Document &other)
+{
+    for (auto &[uu, group] : groups) {
+        auto gr = dynamic_cast<IGroupSolidModel *>(group.get());
+        if (!gr || !other.m_groups.contains(uu))
+            continue;
+        if (auto other_gr = dynamic_cast<const IGroupSolidModel *>(other.m_groups.at(uu).get()))
+            gr->copy_solid_model_from(*other_gr);
+    }
+    groups_update_solid_model_pending = other.m_groups_update_solid_model_pending;
+    solid_model_keys = other.m_solid_model_keys;
+}
+
+Document Document::new_from_file(const std::filesystem::path &path, SolidModelUpdate solid_model_update)
 {
-    return Document{load_json_from_file(path), path.parent_path()};
+    DocumentLoader loader{path.parent_path()};
+    loader.load(path);
+    return Document{loader, solid_model_update};
 }
 
 std::vector<Group *> Document::get_groups_sorted()
@@ -156,91 +372,298 @@ std::vector<Document::BodyGroups> Document::get_groups_by_body() const
 void Document::update_pending(const UUID &last_group_to_update_i, const std::vector<EntityAndPoint> &dragged)
 {
     try {
+        // anything but a drag step may change the document's structure
+        if (dragged.empty() || m_groups_generate_pending.size() || dragged != m_drag_systems_dragged)
+            m_drag_systems.clear();
+        m_drag_systems_dragged = dragged;
+
+        // constraints may have been changed to reference other entities
+        m_index.entity_constraints.reset();
+
         auto groups_sorted = get_groups_sorted();
         if (groups_sorted.empty())
             return;
         const UUID last_group_to_update =
                 last_group_to_update_i == groups_sorted.back()->m_uuid ? UUID() : last_group_to_update_i;
-        auto get_first_index = [this](const UUID &uu) {
-            if (m_groups.contains(uu))
-                return get_group(uu).get_index();
-            else
-                return INT_MAX;
-        };
+        // groups after the last one to update stay pending
+        int last_index = INT_MAX;
+        if (last_group_to_update && m_groups.contains(last_group_to_update))
+            last_index = get_group(last_group_to_update).get_index();
+
+        GroupDependencies deps;
+        const auto groups_generate = get_dirty_groups(m_groups_generate_pending, deps, false);
+        const auto groups_solve = get_dirty_groups(m_groups_solve_pending, deps, false);
+        const auto groups_update_solid_model = get_dirty_groups(m_groups_update_solid_model_pending, deps, true);
+        m_groups_generate_pending.clear();
+        m_groups_solve_pending.clear();
+        m_groups_update_solid_model_pending.clear();
 
-        const auto first_generate_index = get_first_index(m_first_group_generate);
-        const auto first_solve_index = get_first_index(m_first_group_solve);
-        const auto first_update_solid_model_index = get_first_index(m_first_group_update_solid_model);
-        const Group *last_group = nullptr;
         // first pass: generate
-        if (m_first_group_generate) {
-            for (auto group : groups_sorted) {
-                if (last_group && last_group->m_uuid == last_group_to_update) {
-                    // we've seen all groups we needed to see, update to the rest
-                    if (m_first_group_generate)
-                        m_first_group_generate = group->m_uuid;
-                    break;
-                }
-                const auto index = group->get_index();
-                if (index >= first_generate_index) {
-                    generate_group(*group);
-                }
-                last_group = group;
+        for (auto group : groups_sorted) {
+            if (!groups_generate.contains(group->m_uuid))
+                continue;
+            if (group->get_index() > last_index) {
+                m_groups_generate_pending.insert(group->m_uuid);
+            }
+            else {
+                generate_group(*group);
+                set_group_changed(group->m_uuid);
             }
         }
-        if (!last_group_to_update)
-            m_first_group_generate = UUID();
 
         erase_invalid();
 
-        last_group = nullptr;
         for (auto group : groups_sorted) {
-            if (last_group && last_group->m_uuid == last_group_to_update) {
-                // we've seen all groups we needed to see, update to the rest
-                if (m_first_group_solve)
-                    m_first_group_solve = group->m_uuid;
-                if (m_first_group_update_solid_model)
-                    m_first_group_update_solid_model = group->m_uuid;
-                return;
+            if (!groups_solve.contains(group->m_uuid))
+                continue;
+            if (group->get_index() > last_index) {
+                m_groups_solve_pending.insert(group->m_uuid);
             }
-            const auto index = group->get_index();
-            if (index >= first_solve_index) {
+            else {
                 solve_group(*group, dragged);
+                set_group_changed(group->m_uuid);
             }
-            if (index >= first_update_solid_model_index) {
-                update_solid_model(*group);
-            }
+        }
 
-            last_group = group;
+        if (m_solid_model_update_deferred) {
+            m_groups_update_solid_model_pending = groups_update_solid_model;
+            return;
         }
-        // we've seen all groups, reset all pendings
-        m_first_group_solve = UUID();
-        m_first_group_update_solid_model = UUID();
+        std::set<UUID> groups_update_solid_model_now;
+        for (auto group : groups_sorted) {
+            if (!groups_update_solid_model.contains(group->m_uuid))
+                continue;
+            if (group->get_index() > last_index)
+                m_groups_update_solid_model_pending.insert(group->m_uuid);
+            else
+                groups_update_solid_model_now.insert(group->m_uuid);
+        }
+        update_solid_models(groups_update_solid_model_now, deps, [] { return false; });
     }
     CATCH_LOG(Logger::Level::CRITICAL, "error updating document", Logger::Domain::DOCUMENT)
 }
 
+const std::set<UUID> &Document::get_group_dependencies(const Group &group, GroupDependencies &deps) const
+{
+    if (auto it = deps.find(group.m_uuid); it != deps.end())
+        return it->second;
+
+    auto r = group.get_required_groups(*this);
+    for (const auto &uu : group.get_referenced_entities(*this)) {
+        // may reference entities that have been deleted
+        if (auto it = m_entities.find(uu); it != m_entities.end())
+            r.insert(it->second->m_group);
+    }
+    r.erase(group.m_uuid);
+    return deps.emplace(group.m_uuid, std::move(r)).first->second;
+}
+
+std::set<UUID> Document::get_dirty_groups(const std::set<UUID> &pending, GroupDependencies &deps,
+                                          bool solid_model) const
+{
+    std::set<UUID> dirty;
+    const Group *previous_group = nullptr;
+    for (auto group : get_groups_sorted()) {
+        bool is_dirty = pending.contains(group->m_uuid);
+        if (!is_dirty && dirty.size()) {
+            if (solid_model && previous_group && !group->m_body && dirty.contains(previous_group->m_uuid))
+                is_dirty = true;
+            else
+                is_dirty = std::ranges::any_of(get_group_dependencies(*group, deps),
+                                               [&dirty](const auto &uu) { return dirty.contains(uu); });
+        }
+        if (is_dirty)
+            dirty.insert(group->m_uuid);
+        previous_group = group;
+    }
+    return dirty;
+}
+
 void Document::generate_group(Group &group)
 {
     if (auto gg = dynamic_cast<IGroupGenerate *>(&group)) {
-        for (auto &[uu, it] : m_entities) {
-            if (it->m_group == group.m_uuid && it->m_kind == ItemKind::GENRERATED) {
-                it->m_kind = ItemKind::GENRERATED_STALE;
-                it->m_generated_from = UUID();
+        for (const auto &uu : get_group_entities(group.m_uuid)) {
+            auto &en = *m_entities.at(uu);
+            if (en.m_kind == ItemKind::GENRERATED) {
+                en.m_kind = ItemKind::GENRERATED_STALE;
+                en.m_generated_from = UUID();
             }
         }
         gg->generate(*this);
-        map_erase_if(m_entities, [&group](auto &x) {
-            return x.second->m_group == group.m_uuid && x.second->m_kind == ItemKind::GENRERATED_STALE;
-        });
+        std::vector<UUID> stale;
+        for (const auto &uu : get_group_entities(group.m_uuid)) {
+            if (m_entities.at(uu)->m_kind == ItemKind::GENRERATED_STALE)
+                stale.push_back(uu);
+        }
+        for (const auto &uu : stale) {
+            erase_entity(uu);
+        }
     }
 }
 
 
 void Document::update_solid_model(Group &group)
 {
-    if (auto gr = dynamic_cast<IGroupSolidModel *>(&group))
-        gr->update_solid_model(*this);
+    auto gr = dynamic_cast<IGroupSolidModel *>(&group);
+    if (!gr)
+        return;
+    auto &cache = SolidModelCache::get();
+    const auto key = m_solid_model_keys.find(group.m_uuid);
+    if (key != m_solid_model_keys.end() && cache.restore(key->second, *gr))
+        return;
+    gr->update_solid_model(*this);
+    if (key != m_solid_model_keys.end())
+        cache.store(key->second, group);
+}
+
+std::optional<UUID> Document::get_solid_model_key(const Group &group, GroupDependencies &deps) const
+{
+    std::vector<UUID> uuids = {group.m_uuid};
+
+    // the solid model is built on top of the ones of the previous groups in the same body
+    const Group *previous_group = nullptr;
+    for (auto gr : get_groups_sorted()) {
+        if (gr == &group)
+            break;
+        if (gr->m_body)
+            previous_group = nullptr;
+        if (dynamic_cast<const IGroupSolidModel *>(gr))
+            previous_group = gr;
+    }
+    if (previous_group && !group.m_body) {
+        auto it = m_solid_model_keys.find(previous_group->m_uuid);
+        if (it == m_solid_model_keys.end())
+            return {};
+        uuids.push_back(it->second);
+    }
+
+    // entities only change along with the revision of their group, so there's
+    // no need to look at them, unlike the group's own settings, such as the operation
+    std::string data = group.serialize(*this).dump();
+    auto append_revision = [this, &data](const UUID &group_uu) {
+        const auto revision = get_group_revision(group_uu);
+        data += std::format(" {}:{}", (std::string)group_uu, revision);
+        return revision != 0;
+    };
+    if (!append_revision(group.m_uuid))
+        return {};
+    for (const auto &uu : get_group_dependencies(group, deps)) {
+        if (!append_revision(uu))
+            return {};
+        // such as the source group of arrays
+        if (dynamic_cast<const IGroupSolidModel *>(&get_group(uu))) {
+            auto it = m_solid_model_keys.find(uu);
+            if (it == m_solid_model_keys.end())
+                return {};
+            uuids.push_back(it->second);
+        }
+    }
+
+    // glue and fuzzy value may change the result of booleans, the color ends up in the faces
+    const auto &settings = m_solid_model_settings;
+    data += std::format("glue={} fuzzy={} color={},{},{}", settings.glue, settings.fuzzy_value, settings.color.r,
+                        settings.color.g, settings.color.b);
+
+    return hash_uuids("0b4b5cbc-f5de-4b1b-a3ec-5f3c2e6b1d0e", uuids,
+                      {reinterpret_cast<const uint8_t *>(data.data()), data.size()});
+}
+
+bool Document::update_solid_models(const SolidModelSettings &settings, const std::function<bool()> &cancelled)
+{
+    m_solid_model_settings = settings;
+    try {
+        GroupDependencies deps;
+        const auto groups = get_dirty_groups(m_groups_update_solid_model_pending, deps, true);
+        if (!update_solid_models(groups, deps, cancelled))
+            return false;
+        m_groups_update_solid_model_pending.clear();
+        return true;
+    }
+    CATCH_LOG(Logger::Level::CRITICAL, "error updating solid models", Logger::Domain::DOCUMENT)
+    return false;
+}
+
+bool Document::update_solid_models(const std::set<UUID> &groups, GroupDependencies &deps,
+                                   const std::function<bool()> &cancelled)
+{
+    // Each group ends up in the first batch after the batches of all groups it
+    // depends on, so that groups in the same batch, such as the ones of
+    // independent bodies, can be updated concurrently.
+    std::map<UUID, unsigned int> batch_of_group;
+    std::map<unsigned int, std::vector<Group *>> batches;
+    const Group *previous_group = nullptr;
+    for (auto group : get_groups_sorted()) {
+        if (groups.contains(group->m_uuid)) {
+            unsigned int batch = 0;
+            auto after = [&batch_of_group, &batch](const UUID &uu) {
+                if (auto it = batch_of_group.find(uu); it != batch_of_group.end())
+                    batch = std::max(batch, it->second + 1);
+            };
+            for (const auto &uu : get_group_dependencies(*group, deps)) {
+                after(uu);
+            }
+            if (previous_group && !group->m_body)
+                after(previous_group->m_uuid);
+            batch_of_group.emplace(group->m_uuid, batch);
+            batches[batch].push_back(const_cast<Group *>(group));
+        }
+        previous_group = group;
+    }
+
+    // keys only depend on the inputs, so they can be determined before
+    // updating any solid models
+    for (auto group : get_groups_sorted()) {
+        if (groups.contains(group->m_uuid) && dynamic_cast<const IGroupSolidModel *>(group)) {
+            // without a key, the solid model can't come from or go to the cache
+            if (auto key = get_solid_model_key(*group, deps))
+                m_solid_model_keys[group->m_uuid] = *key;
+            else
+                m_solid_model_keys.erase(group->m_uuid);
+        }
+    }
+
+    // lookups from the worker threads mustn't modify the index
+    update_index();
+
+    for (auto &[batch, batch_groups] : batches) {
+        if (cancelled())
+            return false;
+        auto update = [this, &batch_groups](size_t i) {
+            auto &group = *batch_groups.at(i);
+            const auto t_start = std::chrono::steady_clock::now();
+            update_solid_model(group);
+            const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t_start;
+            if (m_solid_model_settings.log_timing)
+                Logger::log_info(std::format("updated solid model of group {} in {:.1f}ms", group.m_name, dt.count()),
+                                 Logger::Domain::DOCUMENT);
+        };
+        if (batch_groups.size() == 1) {
+            update(0);
+        }
+        else {
+            std::vector<std::future<void>> futures;
+            for (size_t i = 0; i < batch_groups.size(); i++) {
+                futures.push_back(std::async(std::launch::async, update, i));
+            }
+            for (auto &future : futures) {
+                future.get();
+            }
+        }
+    }
+    return true;
+}
+
+void Document::copy_solid_models_from(const Document &other)
+{
+    for (auto &[uu, group] : m_groups) {
+        auto gr = dynamic_cast<IGroupSolidModel *>(group.get());
+        if (!gr || !other.m_groups.contains(uu))
+            continue;
+        if (auto other_gr = dynamic_cast<const IGroupSolidModel *>(other.m_groups.at(uu).get()))
+            gr->copy_solid_model_from(*other_gr);
+    }
+    m_groups_update_solid_model_pending = other.m_groups_update_solid_model_pending;
+    m_solid_model_keys = other.m_solid_model_keys;
 }
 
 static std::string make_json_link(const std::string &label, const json &j)
@@ -256,11 +679,20 @@ void Document::solve_group(Group &group, const std::vector<EntityAndPoint> &drag
         group.m_solve_result = SolveResult::OKAY;
         return;
     }
-    System system{*this, group.m_uuid};
-    for (const auto &[en, pt] : dragged) {
-        system.add_dragged(en, pt);
+    std::unique_ptr<System> system_new;
+    System *system = nullptr;
+    if (auto it = m_drag_systems.find(group.m_uuid); it != m_drag_systems.end()) {
+        system = it->second.get();
+        system->update_from_document();
+    }
+    else {
+        system_new = std::make_unique<System>(*this, group.m_uuid);
+        for (const auto &[en, pt] : dragged) {
+            system_new->add_dragged(en, pt);
+        }
+        system = system_new.get();
     }
-    const auto res = system.solve();
+    const auto res = system->solve();
     group.m_solve_result = res.result;
     group.m_dof = res.dof;
     group.m_solve_messages.clear();
@@ -293,7 +725,10 @@ void Document::solve_group(Group &group, const std::vector<EntityAndPoint> &drag
         break;
     }
     group.m_bad_constraints.reset();
-    system.update_document();
+    system->update_document();
+
+    if (system_new && dragged.size())
+        m_drag_systems.emplace(group.m_uuid, std::move(system_new));
 }
 
 void Document::insert_group(std::unique_ptr<Group> new_group, const UUID &after)
@@ -443,19 +878,14 @@ ItemsToDelete Document::get_additional_items_to_delete(const ItemsToDelete &item
             }
         }
 
-        for (const auto &[uu, it] : m_constraints) {
-            if (items.constraints.contains(uu))
-                continue;
-            if (items.groups.contains(it->m_group)) {
+        for (const auto &group : items.groups) {
+            for (const auto &uu : get_group_constraints(group)) {
                 items.constraints.insert(uu);
-                continue;
             }
-            auto refs = it->get_referenced_entities();
-            for (auto &ref : refs) {
-                if (items.entities.contains(ref)) {
-                    items.constraints.insert(uu);
-                    break;
-                }
+        }
+        for (const auto &entity : items.entities) {
+            for (const auto &uu : get_entity_constraints(entity)) {
+                items.constraints.insert(uu);
             }
         }
 
@@ -493,15 +923,30 @@ ItemsToDelete Document::get_additional_items_to_delete(const ItemsToDelete &item
 
 void Document::delete_items(const ItemsToDelete &items)
 {
-    set_group_generate_pending(items.get_first_group(*this));
+    // groups that lose items as well as the ones following deleted groups,
+    // since they're now built on top of different solid models
+    std::set<UUID> groups_changed;
+    for (const auto &it : items.entities) {
+        groups_changed.insert(get_entity(it).m_group);
+    }
+    for (const auto &it : items.constraints) {
+        groups_changed.insert(get_constraint(it).m_group);
+    }
+    for (const auto &it : items.groups) {
+        auto next = get_group_rel(it, 1);
+        while (items.groups.contains(next))
+            next = get_group_rel(next, 1);
+        groups_changed.insert(next);
+    }
+
     for (auto &it : items.entities) {
-        m_entities.erase(it);
+        erase_entity(it);
     }
     for (auto &it : items.groups) {
         m_groups.erase(it);
     }
     for (auto &it : items.constraints) {
-        m_constraints.erase(it);
+        erase_constraint(it);
     }
 
     for (auto &[uu, gr] : m_groups) {
@@ -510,6 +955,11 @@ void Document::delete_items(const ItemsToDelete &items)
         if (!m_entities.contains(gr->m_active_wrkpl))
             gr->m_active_wrkpl = UUID();
     }
+
+    for (const auto &uu : groups_changed) {
+        if (m_groups.contains(uu))
+            set_group_generate_pending(uu);
+    }
 }
 
 glm::dvec3 Document::get_point(const EntityAndPoint &ep) const
@@ -522,33 +972,36 @@ bool Document::is_valid_point(const EntityAndPoint &ep) const
     return get_entity(ep.entity).is_valid_point(ep.point);
 }
 
-void Document::update_group_if_less(UUID &uu, const UUID &new_group)
-{
-    if (uu == UUID()) {
-        uu = new_group;
-        return;
-    }
-    auto current_index = get_group(uu).get_index();
-    auto new_index = get_group(new_group).get_index();
-    if (new_index < current_index)
-        uu = new_group;
-}
-
 void Document::set_group_generate_pending(const UUID &group)
 {
-    update_group_if_less(m_first_group_generate, group);
+    m_groups_generate_pending.insert(group);
     set_group_solve_pending(group);
 }
 
 void Document::set_group_solve_pending(const UUID &group)
 {
-    update_group_if_less(m_first_group_solve, group);
+    m_groups_solve_pending.insert(group);
+    set_group_changed(group);
     set_group_update_solid_model_pending(group);
 }
 
 void Document::set_group_update_solid_model_pending(const UUID &group)
 {
-    update_group_if_less(m_first_group_update_solid_model, group);
+    m_groups_update_solid_model_pending.insert(group);
+}
+
+void Document::set_group_changed(const UUID &group)
+{
+    static std::atomic<uint64_t> last_revision = 0;
+    m_groups_changed.insert(group);
+    m_group_revisions[group] = ++last_revision;
+}
+
+uint64_t Document::get_group_revision(const UUID &group) const
+{
+    if (auto it = m_group_revisions.find(group); it != m_group_revisions.end())
+        return it->second;
+    return 0;
 }
 
 UUID Document::get_group_after(const UUID &group_uu, MoveGroup dir) const
@@ -595,7 +1048,11 @@ UUID Document::get_group_after(const UUID &group_uu, MoveGroup dir) const
 std::set<const Constraint *> Document::find_constraints(const std::set<EntityAndPoint> &enps) const
 {
     std::set<const Constraint *> r;
-    for (const auto &[uu, constr] : m_constraints) {
+    if (enps.empty())
+        return r;
+    // only constraints referencing all of the points can match
+    for (const auto &uu : get_entity_constraints(enps.begin()->entity)) {
+        auto &constr = m_constraints.at(uu);
         if (auto iconstraint_datum = dynamic_cast<const IConstraintDatum *>(constr.get())) {
             if (iconstraint_datum->is_measurement())
                 continue;
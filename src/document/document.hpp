@@ -5,9 +5,13 @@
 #include "nlohmann/json_fwd.hpp"
 #include <filesystem>
 #include <set>
+#include <vector>
+#include <optional>
+#include <functional>
 #include <glm/glm.hpp>
 #include "util/file_version.hpp"
 #include "entity/entity_and_point.hpp"
+#include "solid_model_settings.hpp"
 
 namespace dune3d {
 using json = nlohmann::json;
@@ -15,6 +19,7 @@ class Entity;
 class Constraint;
 class Group;
 class Body;
+class System;
 enum class GroupType;
 
 struct ItemsToDelete {
@@ -33,9 +38,38 @@ class Document {
 public:
     Document();
     explicit Document(const json &j, const std::filesystem::path &containing_dir);
-    static Document new_from_file(const std::filesystem::path &path);
+    // DEFERRED leaves all solid models pending, see set_solid_model_update_deferred
+    enum class SolidModelUpdate { NOW, DEFERRED };
+    static Document new_from_file(const std::filesystem::path &path,
+                                  SolidModelUpdate solid_model_update = SolidModelUpdate::NOW);
     Document(const Document &other);
 
+    // Copy of the document for the undo history. Entities and constraints of
+    // groups that haven't been changed since the previous snapshot are shared
+    // with it instead of getting cloned, so that taking a snapshot only costs
+    // what has changed.
+    struct Snapshot {
+        Snapshot(const FileVersion &v);
+        FileVersion version;
+        std::map<UUID, std::shared_ptr<const Entity>> entities;
+        std::map<UUID, std::shared_ptr<const Constraint>> constraints;
+        // groups are few and may change without being marked pending, so they're always cloned
+        std::map<UUID, std::unique_ptr<Group>> groups;
+
+        std::set<UUID> groups_generate_pending;
+        std::set<UUID> groups_solve_pending;
+        std::set<UUID> groups_update_solid_model_pending;
+        bool solid_model_update_deferred = false;
+        std::map<UUID, UUID> solid_model_keys;
+        std::map<UUID, uint64_t> group_revisions;
+
+        void copy_solid_models_from(const Document &other);
+
+        ~Snapshot();
+    };
+    std::unique_ptr<Snapshot> make_snapshot(const Snapshot *previous);
+    explicit Document(const Snapshot &snapshot);
+
     std::map<UUID, std::unique_ptr<Entity>> m_entities;
     std::map<UUID, std::unique_ptr<Constraint>> m_constraints;
 
@@ -47,6 +81,7 @@ public:
         auto en = std::make_unique<T>(uu);
         auto p = en.get();
         m_entities.emplace(uu, std::move(en));
+        m_index.pending_entities.push_back(uu);
         return *p;
     }
 
@@ -94,9 +129,22 @@ public:
         auto en = std::make_unique<T>(uu);
         auto p = en.get();
         m_constraints.emplace(uu, std::move(en));
+        m_index.pending_constraints.push_back(uu);
+        m_index.entity_constraints.reset();
         return *p;
     }
 
+    // use these rather than erasing from m_entities or m_constraints directly
+    // to keep the indices below up to date
+    void erase_entity(const UUID &uu);
+    void erase_constraint(const UUID &uu);
+
+    // Entities and constraints in a group and constraints referencing an entity.
+    // Like m_entities and m_constraints, these are sorted by UUID.
+    const std::set<UUID> &get_group_entities(const UUID &group) const;
+    const std::set<UUID> &get_group_constraints(const UUID &group) const;
+    const std::set<UUID> &get_entity_constraints(const UUID &entity) const;
+
     const auto &get_groups() const
     {
         return m_groups;
@@ -157,6 +205,33 @@ public:
     void set_group_generate_pending(const UUID &group);
     void set_group_solve_pending(const UUID &group);
     void set_group_update_solid_model_pending(const UUID &group);
+    // for changes to a group's entities or constraints that don't need any
+    // updates, but need to end up in the next snapshot
+    void set_group_changed(const UUID &group);
+
+    // Changes whenever set_group_changed gets called for the group, either
+    // explicitly or by marking it pending. Unique across all documents, 0 if unknown.
+    uint64_t get_group_revision(const UUID &group) const;
+
+    // When deferred, update_pending leaves solid models alone and keeps them pending
+    // so that they can be updated on a copy of the document using update_solid_models.
+    void set_solid_model_update_deferred(bool deferred)
+    {
+        m_solid_model_update_deferred = deferred;
+    }
+    bool get_solid_model_update_pending() const
+    {
+        return m_groups_update_solid_model_pending.size();
+    }
+
+    // Returns false if cancelled, which gets checked before every batch of
+    // independent groups. The settings are kept for updates from update_pending.
+    bool update_solid_models(const SolidModelSettings &settings, const std::function<bool()> &cancelled);
+    const SolidModelSettings &get_solid_model_settings() const
+    {
+        return m_solid_model_settings;
+    }
+    void copy_solid_models_from(const Document &other);
 
     enum class MoveGroup { UP, DOWN, END_OF_BODY, END_OF_DOCUMENT };
     UUID get_group_after(const UUID &group, MoveGroup dir) const;
@@ -175,17 +250,66 @@ public:
     ~Document();
 
 private:
+    Document(class DocumentLoader &loader, SolidModelUpdate solid_model_update);
+    void load_finish();
+
     std::map<UUID, std::unique_ptr<Group>> m_groups;
 
-    UUID m_first_group_generate;
-    UUID m_first_group_solve;
-    UUID m_first_group_update_solid_model;
+    // only groups that are pending or depend on a pending group get updated
+    std::set<UUID> m_groups_generate_pending;
+    std::set<UUID> m_groups_solve_pending;
+    std::set<UUID> m_groups_update_solid_model_pending;
+    bool m_solid_model_update_deferred = false;
+    SolidModelSettings m_solid_model_settings;
+
+    // hash of the inputs of each group's current solid model, see get_solid_model_key
+    std::map<UUID, UUID> m_solid_model_keys;
+
+    // groups whose entities or constraints may have been modified since the
+    // last snapshot, that's all groups that have been marked pending or updated
+    std::set<UUID> m_groups_changed;
+    std::map<UUID, uint64_t> m_group_revisions;
 
     void generate_group(Group &group);
     void solve_group(Group &group, const std::vector<EntityAndPoint> &dragged);
     void update_solid_model(Group &group);
 
-    void update_group_if_less(UUID &uu, const UUID &new_group);
+    using GroupDependencies = std::map<UUID, std::set<UUID>>;
+    // groups whose entities are used by the given group
+    const std::set<UUID> &get_group_dependencies(const Group &group, GroupDependencies &deps) const;
+    // pending groups and all groups depending on them, a group's solid model
+    // also depends on the one of the previous group in the same body
+    std::set<UUID> get_dirty_groups(const std::set<UUID> &pending, GroupDependencies &deps, bool solid_model) const;
+    bool update_solid_models(const std::set<UUID> &groups, GroupDependencies &deps,
+                             const std::function<bool()> &cancelled);
+    std::optional<UUID> get_solid_model_key(const Group &group, GroupDependencies &deps) const;
+
+    struct Index {
+        // false if the group indices need to be rebuilt from scratch
+        bool valid = false;
+        std::map<UUID, std::set<UUID>> group_entities;
+        std::map<UUID, std::set<UUID>> group_constraints;
+        size_t n_entities = 0;
+        size_t n_constraints = 0;
+
+        // an item's group is usually set after adding it, so newly added
+        // items get indexed on the next lookup
+        std::vector<UUID> pending_entities;
+        std::vector<UUID> pending_constraints;
+
+        // constraints may change which entities they reference at any time,
+        // so this one gets rebuilt on demand after updating the document
+        std::optional<std::map<UUID, std::set<UUID>>> entity_constraints;
+
+        void invalidate();
+    };
+    mutable Index m_index;
+    void update_index() const;
+
+    // Systems of the groups solved while dragging, kept across update_pending calls
+    // so that consecutive drag steps only need to update parameter values
+    std::map<UUID, std::unique_ptr<System>> m_drag_systems;
+    std::vector<EntityAndPoint> m_drag_systems_dragged;
 
     void insert_group(std::unique_ptr<Group> group, const UUID &after);
 };
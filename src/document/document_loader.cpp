@@ -0,0 +1,221 @@
+#include "document_loader.hpp"
+#include "entity/entity.hpp"
+#include "constraint/constraint.hpp"
+#include "group/group.hpp"
+#include <fstream>
+
+namespace dune3d {
+
+DocumentLoader::DocumentLoader(const std::filesystem::path &containing_dir) : m_containing_dir(containing_dir)
+{
+}
+
+DocumentLoader::~DocumentLoader() = default;
+
+static bool is_binary(std::istream &ifs)
+{
+    // JSON documents start with an object, CBOR ones with a map header,
+    // that's major type 5 in the upper three bits
+    ifs >> std::ws;
+    const auto c = ifs.peek();
+    if (c == std::istream::traits_type::eof())
+        throw std::runtime_error("file is empty");
+    if (c == '{')
+        return false;
+    if ((c & 0xe0) == 0xa0)
+        return true;
+    throw std::runtime_error("file is neither a JSON nor a CBOR document");
+}
+
+bool DocumentLoader::is_binary(const std::filesystem::path &path)
+{
+    std::ifstream ifs{path, std::ios::binary};
+    if (!ifs.is_open())
+        return false;
+    return dune3d::is_binary(ifs);
+}
+
+static const char *get_section_name(DocumentLoader::Section section)
+{
+    switch (section) {
+    case DocumentLoader::Section::ENTITIES:
+        return "entities";
+    case DocumentLoader::Section::CONSTRAINTS:
+        return "constraints";
+    case DocumentLoader::Section::GROUPS:
+        return "groups";
+    case DocumentLoader::Section::NONE:;
+    }
+    return "";
+}
+
+void DocumentLoader::load(const std::filesystem::path &path)
+{
+    std::ifstream ifs{path, std::ios::binary};
+    if (!ifs.is_open()) {
+        throw std::runtime_error("file " + path.string() + " not opened");
+    }
+    const auto format = dune3d::is_binary(ifs) ? json::input_format_t::cbor : json::input_format_t::json;
+    json::sax_parse(ifs, this, format);
+    // like json::at in the constructor that takes a json
+    for (const auto section : {Section::ENTITIES, Section::CONSTRAINTS, Section::GROUPS}) {
+        if (!m_seen_sections.contains(section))
+            throw std::runtime_error(std::string{"document has no "} + get_section_name(section));
+    }
+}
+
+json &DocumentLoader::add(json &&j)
+{
+    // sections can't be stored anywhere but in their maps
+    if (m_next_section != Section::NONE)
+        throw std::runtime_error(std::string{get_section_name(m_next_section)} + " isn't an object");
+    if (m_stack.empty())
+        throw std::runtime_error("document isn't an object");
+    if (m_depth == 2 && m_section != Section::NONE)
+        throw std::runtime_error("item " + (std::string)m_item_uuid + " isn't an object");
+    auto &parent = *m_stack.back();
+    if (parent.is_array()) {
+        parent.push_back(std::move(j));
+        return parent.back();
+    }
+    *m_element = std::move(j);
+    return *m_element;
+}
+
+bool DocumentLoader::null()
+{
+    add(nullptr);
+    return true;
+}
+
+bool DocumentLoader::boolean(bool val)
+{
+    add(val);
+    return true;
+}
+
+bool DocumentLoader::number_integer(number_integer_t val)
+{
+    add(val);
+    return true;
+}
+
+bool DocumentLoader::number_unsigned(number_unsigned_t val)
+{
+    add(val);
+    return true;
+}
+
+bool DocumentLoader::number_float(number_float_t val, const string_t &s)
+{
+    add(val);
+    return true;
+}
+
+bool DocumentLoader::string(string_t &val)
+{
+    add(std::move(val));
+    return true;
+}
+
+bool DocumentLoader::binary(binary_t &val)
+{
+    add(json::binary(std::move(val)));
+    return true;
+}
+
+bool DocumentLoader::start_object(std::size_t elements)
+{
+    if (m_depth == 0) {
+        m_stack.push_back(&m_header);
+    }
+    else if (m_depth == 1 && m_next_section != Section::NONE) {
+        m_section = m_next_section;
+        m_seen_sections.insert(m_section);
+        m_next_section = Section::NONE;
+    }
+    else if (m_depth == 2 && m_section != Section::NONE) {
+        m_item = json::object();
+        m_stack.push_back(&m_item);
+    }
+    else {
+        m_stack.push_back(&add(json::object()));
+    }
+    m_depth++;
+    return true;
+}
+
+bool DocumentLoader::key(string_t &val)
+{
+    if (m_depth == 1) {
+        m_element = nullptr;
+        if (val == "entities")
+            m_next_section = Section::ENTITIES;
+        else if (val == "constraints")
+            m_next_section = Section::CONSTRAINTS;
+        else if (val == "groups")
+            m_next_section = Section::GROUPS;
+        else
+            m_element = &m_header[val];
+    }
+    else if (m_depth == 2 && m_section != Section::NONE) {
+        m_item_uuid = val;
+    }
+    else {
+        m_element = &(*m_stack.back())[val];
+    }
+    return true;
+}
+
+void DocumentLoader::finish_item()
+{
+    switch (m_section) {
+    case Section::ENTITIES:
+        m_entities.emplace(m_item_uuid, Entity::new_from_json(m_item_uuid, m_item, m_containing_dir));
+        break;
+    case Section::CONSTRAINTS:
+        m_constraints.emplace(m_item_uuid, Constraint::new_from_json(m_item_uuid, m_item));
+        break;
+    case Section::GROUPS:
+        m_groups.emplace(m_item_uuid, Group::new_from_json(m_item_uuid, m_item));
+        break;
+    case Section::NONE:;
+    }
+    m_item = nullptr;
+}
+
+bool DocumentLoader::end_object()
+{
+    if (m_depth == 2 && m_section != Section::NONE) {
+        m_section = Section::NONE;
+    }
+    else {
+        m_stack.pop_back();
+        if (m_depth == 3 && m_section != Section::NONE)
+            finish_item();
+    }
+    m_depth--;
+    return true;
+}
+
+bool DocumentLoader::start_array(std::size_t elements)
+{
+    m_stack.push_back(&add(json::array()));
+    m_depth++;
+    return true;
+}
+
+bool DocumentLoader::end_array()
+{
+    m_stack.pop_back();
+    m_depth--;
+    return true;
+}
+
+bool DocumentLoader::parse_error(std::size_t position, const std::string &last_token,
+                                 const nlohmann::detail::exception &ex)
+{
+    throw std::runtime_error(ex.what());
+}
+
+} // namespace dune3d
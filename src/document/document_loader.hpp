@@ -0,0 +1,73 @@
+#pragma once
+#include "util/uuid.hpp"
+#include "nlohmann/json.hpp"
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace dune3d {
+using json = nlohmann::json;
+class Entity;
+class Constraint;
+class Group;
+
+// SAX handler that creates entities, constraints and groups as soon as each
+// of them has been parsed, so that the json of a whole document never needs to
+// be held in memory at once. Works for both JSON and CBOR documents.
+class DocumentLoader : public nlohmann::json_sax<json> {
+public:
+    explicit DocumentLoader(const std::filesystem::path &containing_dir);
+
+    void load(const std::filesystem::path &path);
+    static bool is_binary(const std::filesystem::path &path);
+
+    std::map<UUID, std::unique_ptr<Entity>> m_entities;
+    std::map<UUID, std::unique_ptr<Constraint>> m_constraints;
+    std::map<UUID, std::unique_ptr<Group>> m_groups;
+
+    // everything but the items, such as the version
+    json m_header = json::object();
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t &s) override;
+    bool string(string_t &val) override;
+    bool binary(binary_t &val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t &val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string &last_token,
+                     const nlohmann::detail::exception &ex) override;
+
+    ~DocumentLoader();
+
+    enum class Section { NONE, ENTITIES, CONSTRAINTS, GROUPS };
+
+private:
+    const std::filesystem::path m_containing_dir;
+
+    Section m_section = Section::NONE;
+    Section m_next_section = Section::NONE;
+    std::set<Section> m_seen_sections;
+
+    // 1: document, 2: section, 3: item
+    unsigned int m_depth = 0;
+
+    // the item that's being parsed
+    UUID m_item_uuid;
+    json m_item;
+
+    std::vector<json *> m_stack;
+    json *m_element = nullptr;
+
+    json &add(json &&j);
+    void finish_item();
+};
+
+} // namespace dune3d
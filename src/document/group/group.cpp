@@ -156,17 +156,13 @@ std::set<UUID> Group::get_referenced_entities(const Document &doc) const
     std::set<UUID> r;
     if (m_active_wrkpl)
         r.insert(m_active_wrkpl);
-    for (const auto &[uu, en] : doc.m_entities) {
-        if (en->m_group == m_uuid) {
-            auto refs = en->get_referenced_entities();
-            r.insert(refs.begin(), refs.end());
-        }
+    for (const auto &uu : doc.get_group_entities(m_uuid)) {
+        auto refs = doc.m_entities.at(uu)->get_referenced_entities();
+        r.insert(refs.begin(), refs.end());
     }
-    for (const auto &[uu, co] : doc.m_constraints) {
-        if (co->m_group == m_uuid) {
-            auto refs = co->get_referenced_entities();
-            r.insert(refs.begin(), refs.end());
-        }
+    for (const auto &uu : doc.get_group_constraints(m_uuid)) {
+        auto refs = doc.m_constraints.at(uu)->get_referenced_entities();
+        r.insert(refs.begin(), refs.end());
     }
     return r;
 }
@@ -202,18 +198,8 @@ std::set<UUID> Group::find_redundant_constraints(Document &doc)
 {
     if (!any_of(m_solve_result, SolveResult::REDUNDANT_OKAY, SolveResult::REDUNDANT_DIDNT_CONVERGE))
         return {};
-    std::set<UUID> bad;
-    for (const auto &[uu_constraint, constraint] : doc.m_constraints) {
-        if (constraint->m_group != m_uuid)
-            continue;
-        System sys{doc, m_uuid, uu_constraint};
-        const auto result = sys.solve();
-        if (result.result == SolveResult::OKAY) {
-            bad.insert(uu_constraint);
-        }
-    }
-
-    return bad;
+    System sys{doc, m_uuid};
+    return sys.find_redundant_constraints();
 }
 
 
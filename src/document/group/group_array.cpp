@@ -39,9 +39,19 @@ json GroupArray::serialize() const
     return j;
 }
 
-const SolidModel *GroupArray::get_solid_model() const
+std::shared_ptr<const SolidModel> GroupArray::get_solid_model() const
 {
-    return m_solid_model.get();
+    return m_solid_model;
+}
+
+void GroupArray::copy_solid_model_from(const IGroupSolidModel &other_i)
+{
+    auto other = dynamic_cast<const GroupArray *>(&other_i);
+    if (!other)
+        return;
+    m_solid_model = other->m_solid_model;
+    m_array_messages = other->m_array_messages;
+    m_operation = other->m_operation;
 }
 
 UUID GroupArray::get_entity_uuid(const UUID &uu, unsigned int instance) const
@@ -52,9 +62,10 @@ UUID GroupArray::get_entity_uuid(const UUID &uu, unsigned int instance) const
 
 void GroupArray::generate(Document &doc) const
 {
-    for (const auto &[uu, it] : doc.m_entities) {
-        if (it->m_group != m_source_group)
-            continue;
+    // copy since generating adds entities to the document
+    const auto source_entities = doc.get_group_entities(m_source_group);
+    for (const auto &uu : source_entities) {
+        const auto &it = doc.m_entities.at(uu);
         if (it->m_construction)
             continue;
         for (unsigned int instance = 0; instance < m_count; instance++) {
@@ -127,9 +127,10 @@ void GroupExtrude::generate(Document &doc, Side side) const
         leader.m_name = "leader";
         leader.m_kind = ItemKind::GENRERATED;
     }
-    for (const auto &[uu, it] : doc.m_entities) {
-        if (it->m_group != m_source_group)
-            continue;
+    // copy since generating adds entities to the document
+    const auto source_entities = doc.get_group_entities(m_source_group);
+    for (const auto &uu : source_entities) {
+        const auto &it = doc.m_entities.at(uu);
         if (it->m_construction)
             continue;
         if (it->get_type() == Entity::Type::LINE_2D) {
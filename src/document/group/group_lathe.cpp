@@ -45,9 +45,10 @@ void GroupLathe::generate_or_solve(Document &doc, GenerateOrSolve gen_or_solve)
     const auto n = get_direction(doc).value();
     const auto origin = doc.get_point(m_origin);
 
-    for (const auto &[uu, it] : doc.m_entities) {
-        if (it->m_group != m_source_group)
-            continue;
+    // copy since generating adds entities to the document
+    const auto source_entities = doc.get_group_entities(m_source_group);
+    for (const auto &uu : source_entities) {
+        const auto &it = doc.m_entities.at(uu);
         if (it->m_construction)
             continue;
         if (any_of(it->get_type(), Entity::Type::LINE_2D, Entity::Type::ARC_2D, Entity::Type::CIRCLE_2D)) {
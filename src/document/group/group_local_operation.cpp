@@ -30,9 +30,19 @@ std::list<GroupStatusMessage> GroupLocalOperation::get_messages() const
     return msg;
 }
 
-const SolidModel *GroupLocalOperation::get_solid_model() const
+std::shared_ptr<const SolidModel> GroupLocalOperation::get_solid_model() const
 {
-    return m_solid_model.get();
+    return m_solid_model;
+}
+
+void GroupLocalOperation::copy_solid_model_from(const IGroupSolidModel &other_i)
+{
+    auto other = dynamic_cast<const GroupLocalOperation *>(&other_i);
+    if (!other)
+        return;
+    m_solid_model = other->m_solid_model;
+    m_local_operation_messages = other->m_local_operation_messages;
+    m_operation = other->m_operation;
 }
 
 } // namespace dune3d
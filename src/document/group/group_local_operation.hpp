@@ -33,6 +33,7 @@ public:
 
     std::shared_ptr<const SolidModel> m_solid_model;
 
-    const SolidModel *get_solid_model() const override;
+    std::shared_ptr<const SolidModel> get_solid_model() const override;
+    void copy_solid_model_from(const IGroupSolidModel &other) override;
 };
 } // namespace dune3d
@@ -100,9 +100,10 @@ void GroupRevolve::generate(Document &doc, Side side) const
     auto &wrkpl = doc.get_entity<EntityWorkplane>(m_wrkpl);
     const auto angle = m_angle * get_side_mul(side);
     const auto quat = glm::angleAxis(glm::radians(angle), get_direction(doc).value());
-    for (const auto &[uu, it] : doc.m_entities) {
-        if (it->m_group != m_source_group)
-            continue;
+    // copy since generating adds entities to the document
+    const auto source_entities = doc.get_group_entities(m_source_group);
+    for (const auto &uu : source_entities) {
+        const auto &it = doc.m_entities.at(uu);
         if (it->m_construction)
             continue;
         if (it->get_type() == Entity::Type::LINE_2D) {
@@ -31,9 +31,18 @@ json GroupSweep::serialize() const
     return j;
 }
 
-const SolidModel *GroupSweep::get_solid_model() const
+std::shared_ptr<const SolidModel> GroupSweep::get_solid_model() const
 {
-    return m_solid_model.get();
+    return m_solid_model;
+}
+
+void GroupSweep::copy_solid_model_from(const IGroupSolidModel &other_i)
+{
+    auto other = dynamic_cast<const GroupSweep *>(&other_i);
+    if (!other)
+        return;
+    m_solid_model = other->m_solid_model;
+    m_sweep_messages = other->m_sweep_messages;
 }
 
 std::set<UUID> GroupSweep::get_referenced_entities(const Document &doc) const
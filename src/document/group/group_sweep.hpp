@@ -31,7 +31,8 @@ public:
         return m_operation;
     }
 
-    const SolidModel *get_solid_model() const override;
+    std::shared_ptr<const SolidModel> get_solid_model() const override;
+    void copy_solid_model_from(const IGroupSolidModel &other) override;
 
     std::list<GroupStatusMessage> m_sweep_messages;
     std::list<GroupStatusMessage> get_messages() const override;
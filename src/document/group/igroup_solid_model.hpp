@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 
 namespace dune3d {
 class Document;
@@ -6,8 +7,10 @@ class SolidModel;
 class SolidModelOcc;
 class IGroupSolidModel {
 public:
-    virtual const SolidModel *get_solid_model() const = 0;
+    virtual std::shared_ptr<const SolidModel> get_solid_model() const = 0;
     virtual void update_solid_model(const Document &doc) = 0;
+    // copies what update_solid_model produced from the same group in another document
+    virtual void copy_solid_model_from(const IGroupSolidModel &other) = 0;
     enum class Operation { UNION, DIFFERENCE, INTERSECTION };
     virtual Operation get_operation() const = 0;
 };
@@ -18,10 +18,11 @@ const IGroupSolidModel *SolidModel::get_last_solid_model_group(const Document &d
         if (gr->m_uuid == group.m_uuid)
             break;
         if (auto gr_solid = dynamic_cast<const IGroupSolidModel *>(gr)) {
-            if (auto solid_model = dynamic_cast<const SolidModelOcc *>(gr_solid->get_solid_model())) {
-                auto body = &gr->find_body(doc).body;
-                if (body != this_body)
-                    continue;
+            // solid models of other bodies may be getting updated concurrently
+            auto body = &gr->find_body(doc).body;
+            if (body != this_body)
+                continue;
+            if (auto solid_model = dynamic_cast<const SolidModelOcc *>(gr_solid->get_solid_model().get())) {
                 if (!solid_model->m_shape_acc.IsNull())
                     last_solid_model_group = gr_solid;
             }
@@ -35,7 +36,7 @@ const SolidModel *SolidModel::get_last_solid_model(const Document &doc, const Gr
 {
     auto gr = get_last_solid_model_group(doc, group);
     if (gr)
-        return gr->get_solid_model();
+        return gr->get_solid_model().get();
     else
         return nullptr;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "canvas/face.hpp"
+#include "canvas/faces_lod.hpp"
 #include <memory>
 #include <filesystem>
 #include <vector>
@@ -17,6 +18,8 @@ class IGroupSolidModel;
 class SolidModel {
 public:
     face::Faces m_faces;
+    // other levels get meshed when the canvas needs them
+    std::unique_ptr<face::FacesLOD> m_faces_lod;
     std::map<unsigned int, std::vector<glm::dvec3>> m_edges;
 
     static std::shared_ptr<const SolidModel> create(const Document &doc, GroupExtrude &group);
@@ -7,10 +7,16 @@
 #include <BRepBuilderAPI_Transform.hxx>
 
 #include <BRepAlgoAPI_Fuse.hxx>
+#include <BRepBndLib.hxx>
+#include <BRep_Builder.hxx>
+#include <Bnd_Box.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopTools_ListOfShape.hxx>
 
 #include <gp_Ax2.hxx>
 
 #include <functional>
+#include <vector>
 
 namespace dune3d {
 
@@ -18,7 +24,7 @@ namespace dune3d {
 static std::shared_ptr<const SolidModel> create_array(const Document &doc, GroupArray &group,
                                                       std::function<gp_Trsf(unsigned int)> make_trsf)
 {
-    auto mod = std::make_shared<SolidModelOcc>();
+    auto mod = std::make_shared<SolidModelOcc>(doc.get_solid_model_settings());
     group.m_array_messages.clear();
 
     auto source_group = dynamic_cast<const IGroupSolidModel *>(&doc.get_group(group.m_source_group));
@@ -34,7 +40,7 @@ static std::shared_ptr<const SolidModel> create_array(const Document &doc, Group
     group.m_operation = source_group->get_operation();
 
 
-    const auto source_solid_model = dynamic_cast<const SolidModelOcc *>(source_group->get_solid_model());
+    const auto source_solid_model = dynamic_cast<const SolidModelOcc *>(source_group->get_solid_model().get());
     if (!source_solid_model) {
         return nullptr;
     }
@@ -43,21 +49,57 @@ static std::shared_ptr<const SolidModel> create_array(const Document &doc, Group
         return nullptr;
     }
 
+    Bnd_Box source_box;
+    BRepBndLib::Add(source_solid_model->m_shape, source_box);
+
+    std::vector<TopoDS_Shape> instances;
+    std::vector<Bnd_Box> boxes;
     for (unsigned int instance = 0; instance < group.m_count; instance++) {
         auto trsf = make_trsf(instance);
-        TopoDS_Shape sh = BRepBuilderAPI_Transform(source_solid_model->m_shape, trsf);
-        if (mod->m_shape.IsNull())
-            mod->m_shape = sh;
-        else
-            mod->m_shape = BRepAlgoAPI_Fuse(mod->m_shape, sh);
+        instances.push_back(BRepBuilderAPI_Transform(source_solid_model->m_shape, trsf));
+        boxes.push_back(source_box.Transformed(trsf));
     }
 
-    mod->update_acc(group.m_operation, last_solid_model->m_shape_acc);
+    bool overlapping = false;
+    for (size_t i = 0; i < boxes.size() && !overlapping; i++) {
+        for (size_t j = i + 1; j < boxes.size(); j++) {
+            if (!boxes.at(i).IsOut(boxes.at(j))) {
+                overlapping = true;
+                break;
+            }
+        }
+    }
 
-    if (mod->m_shape_acc.IsNull()) {
-        group.m_array_messages.emplace_back(GroupStatusMessage::Status::ERR, "didn't generate a shape");
-        return nullptr;
+    if (instances.size() == 1) {
+        mod->m_shape = instances.front();
+    }
+    else if (instances.size() && !overlapping) {
+        // instances that don't touch don't need to be fused
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        for (const auto &sh : instances)
+            builder.Add(compound, sh);
+        mod->m_shape = compound;
     }
+    else if (instances.size()) {
+        // fusing all instances at once is a lot faster than one after the other
+        TopTools_ListOfShape arguments;
+        TopTools_ListOfShape tools;
+        arguments.Append(instances.front());
+        for (size_t i = 1; i < instances.size(); i++)
+            tools.Append(instances.at(i));
+
+        BRepAlgoAPI_Fuse fuse;
+        fuse.SetArguments(arguments);
+        fuse.SetTools(tools);
+        if (!mod->build_boolean(fuse, group.m_array_messages))
+            return nullptr;
+        mod->m_shape = fuse.Shape();
+    }
+
+    if (!mod->update_acc(group.m_operation, last_solid_model->m_shape_acc, group.m_array_messages))
+        return nullptr;
 
     mod->find_edges();
     mod->triangulate();
@@ -0,0 +1,42 @@
+#include "solid_model_cache.hpp"
+#include "group/group.hpp"
+#include "group/igroup_solid_model.hpp"
+
+namespace dune3d {
+
+SolidModelCache &SolidModelCache::get()
+{
+    static SolidModelCache cache;
+    return cache;
+}
+
+bool SolidModelCache::restore(const UUID &key, IGroupSolidModel &group)
+{
+    std::lock_guard<std::mutex> guard{m_mutex};
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+        return false;
+    auto cached = dynamic_cast<const IGroupSolidModel *>(it->second->second.get());
+    if (!cached)
+        return false;
+    group.copy_solid_model_from(*cached);
+    m_items.splice(m_items.begin(), m_items, it->second);
+    return true;
+}
+
+void SolidModelCache::store(const UUID &key, const Group &group)
+{
+    std::lock_guard<std::mutex> guard{m_mutex};
+    if (auto it = m_index.find(key); it != m_index.end()) {
+        m_items.erase(it->second);
+        m_index.erase(it);
+    }
+    m_items.emplace_front(key, group.clone());
+    m_index.emplace(key, m_items.begin());
+    while (m_items.size() > s_max_items) {
+        m_index.erase(m_items.back().first);
+        m_items.pop_back();
+    }
+}
+
+} // namespace dune3d
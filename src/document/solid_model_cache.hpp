@@ -0,0 +1,36 @@
+#pragma once
+#include "util/uuid.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace dune3d {
+
+class Group;
+class IGroupSolidModel;
+
+// Keeps solid models of recently updated groups keyed by a hash of everything
+// that went into them, so that undo and redo don't need to rebuild solid
+// models of groups whose inputs haven't changed.
+class SolidModelCache {
+public:
+    static SolidModelCache &get();
+
+    // Returns false if there's no solid model for the key
+    bool restore(const UUID &key, IGroupSolidModel &group);
+    void store(const UUID &key, const Group &group);
+
+private:
+    SolidModelCache() = default;
+
+    std::mutex m_mutex;
+
+    // most recently used first, the groups carry the solid model along with
+    // the messages and whatever else copy_solid_model_from copies
+    std::list<std::pair<UUID, std::unique_ptr<Group>>> m_items;
+    std::map<UUID, decltype(m_items)::iterator> m_index;
+    static constexpr size_t s_max_items = 128;
+};
+
+} // namespace dune3d
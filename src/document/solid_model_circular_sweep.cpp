@@ -11,17 +11,15 @@ namespace dune3d {
 
 
 static std::shared_ptr<const SolidModel> create_circular_sweep(const Document &doc, GroupCircularSweep &group,
-                                                               double angle, FaceBuilder::Transform transform,
-                                                               FaceBuilder::Transform transform_normal)
+                                                               double angle, const gp_Trsf &trsf)
 {
     group.m_sweep_messages.clear();
-    auto mod = std::make_shared<SolidModelOcc>();
+    auto mod = std::make_shared<SolidModelOcc>(doc.get_solid_model_settings());
 
     try {
-        auto face_builder =
-                FaceBuilder::from_document(doc, group.m_wrkpl, group.m_source_group, transform, transform_normal);
+        const auto profile = ProfileFaces::get(doc, group.m_wrkpl, group.m_source_group);
 
-        if (face_builder.get_n_faces() == 0) {
+        if (profile->get_n_faces() == 0) {
             group.m_sweep_messages.emplace_back(GroupStatusMessage::Status::ERR, "no faces");
             return nullptr;
         }
@@ -40,7 +38,7 @@ static std::shared_ptr<const SolidModel> create_circular_sweep(const Document &d
         gp_Ax1 ax{gp_Pnt(origin.x, origin.y, origin.z), gp_Dir(dir.x, dir.y, dir.z)};
 
 
-        BRepPrimAPI_MakeRevol mr{face_builder.get_faces(), ax, angle};
+        BRepPrimAPI_MakeRevol mr{profile->get_faces(trsf), ax, angle};
 
         mr.Build();
         if (!mr.IsDone())
@@ -67,7 +65,8 @@ static std::shared_ptr<const SolidModel> create_circular_sweep(const Document &d
     const auto last_solid_model = dynamic_cast<const SolidModelOcc *>(SolidModel::get_last_solid_model(doc, group));
 
     if (last_solid_model) {
-        mod->update_acc(group.m_operation, last_solid_model->m_shape_acc);
+        if (!mod->update_acc(group.m_operation, last_solid_model->m_shape_acc, group.m_sweep_messages))
+            return nullptr;
     }
     else {
         mod->m_shape_acc = mod->m_shape;
@@ -83,33 +82,31 @@ static std::shared_ptr<const SolidModel> create_circular_sweep(const Document &d
 
 std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupLathe &group)
 {
-    return create_circular_sweep(
-            doc, group, 2 * M_PI, [](const auto &p) { return p; }, [](const auto &p) { return p; });
+    return create_circular_sweep(doc, group, 2 * M_PI, gp_Trsf());
 }
 
 std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupRevolve &group)
 {
-    FaceBuilder::Transform transform;
-    FaceBuilder::Transform transform_normal;
+    gp_Trsf trsf;
     auto angle = glm::radians(group.m_angle);
     switch (group.m_mode) {
     case GroupRevolve::Mode::SINGLE:
-        transform = [](const auto &p) { return p; };
-        transform_normal = [](const auto &p) { return p; };
         break;
     case GroupRevolve::Mode::OFFSET:
     case GroupRevolve::Mode::OFFSET_SYMMETRIC: {
         const double mul = group.get_side_mul(GroupRevolve::Side::BOTTOM);
         auto other_angle = angle * mul;
         angle -= other_angle;
-        transform = [&group, &doc](const auto &p) { return group.transform(doc, p, GroupRevolve::Side::BOTTOM); };
-        transform_normal = [&group, &doc](const auto &p) {
-            return group.transform_normal(doc, p, GroupRevolve::Side::BOTTOM);
-        };
+        // same as GroupRevolve::transform
+        const auto origin = doc.get_point(group.m_origin);
+        const auto dir = group.get_direction(doc);
+        if (!dir)
+            break;
+        trsf.SetRotation(gp_Ax1(gp_Pnt(origin.x, origin.y, origin.z), gp_Dir(dir->x, dir->y, dir->z)), other_angle);
         break;
     }
     }
-    return create_circular_sweep(doc, group, angle, transform, transform_normal);
+    return create_circular_sweep(doc, group, angle, trsf);
 }
 
 } // namespace dune3d
@@ -1,6 +1,7 @@
 #include "solid_model.hpp"
 #include "solid_model_util.hpp"
 #include "solid_model_occ.hpp"
+#include "document.hpp"
 #include "group/group_extrude.hpp"
 
 #include <BRepPrimAPI_MakePrism.hxx>
@@ -10,7 +11,7 @@ namespace dune3d {
 std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupExtrude &group)
 {
     group.m_sweep_messages.clear();
-    auto mod = std::make_shared<SolidModelOcc>();
+    auto mod = std::make_shared<SolidModelOcc>(doc.get_solid_model_settings());
 
 
     glm::dvec3 offset = {0, 0, 0};
@@ -30,9 +31,9 @@ std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupE
     }
 
     try {
-        auto face_builder = FaceBuilder::from_document(doc, group.m_wrkpl, group.m_source_group, offset);
+        const auto profile = ProfileFaces::get(doc, group.m_wrkpl, group.m_source_group);
 
-        if (face_builder.get_n_faces() == 0) {
+        if (profile->get_n_faces() == 0) {
             group.m_sweep_messages.emplace_back(GroupStatusMessage::Status::ERR, "no faces");
             return nullptr;
         }
@@ -42,7 +43,9 @@ std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupE
             return nullptr;
         }
 
-        mod->m_shape = BRepPrimAPI_MakePrism(face_builder.get_faces(), gp_Vec(dvec.x, dvec.y, dvec.z));
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(offset.x, offset.y, offset.z));
+        mod->m_shape = BRepPrimAPI_MakePrism(profile->get_faces(trsf), gp_Vec(dvec.x, dvec.y, dvec.z));
     }
     catch (const Standard_Failure &e) {
         std::ostringstream os;
@@ -63,7 +66,8 @@ std::shared_ptr<const SolidModel> SolidModel::create(const Document &doc, GroupE
     const auto last_solid_model = dynamic_cast<const SolidModelOcc *>(get_last_solid_model(doc, group));
 
     if (last_solid_model) {
-        mod->update_acc(group.m_operation, last_solid_model->m_shape_acc);
+        if (!mod->update_acc(group.m_operation, last_solid_model->m_shape_acc, group.m_sweep_messages))
+            return nullptr;
     }
     else {
         mod->m_shape_acc = mod->m_shape;
@@ -20,7 +20,7 @@ std::shared_ptr<const SolidModel> create_local_operation(const Document &doc, Gr
         return nullptr;
     }
 
-    auto mod = std::make_shared<SolidModelOcc>();
+    auto mod = std::make_shared<SolidModelOcc>(doc.get_solid_model_settings());
 
     const auto last_solid_model_group = SolidModel::get_last_solid_model_group(doc, group);
     if (!last_solid_model_group) {
@@ -28,7 +28,7 @@ std::shared_ptr<const SolidModel> create_local_operation(const Document &doc, Gr
         return nullptr;
     }
     group.m_operation = last_solid_model_group->get_operation();
-    const auto last_solid_model = dynamic_cast<const SolidModelOcc *>(last_solid_model_group->get_solid_model());
+    const auto last_solid_model = dynamic_cast<const SolidModelOcc *>(last_solid_model_group->get_solid_model().get());
     if (!last_solid_model) {
         group.m_local_operation_messages.emplace_back(GroupStatusMessage::Status::ERR, "no solid model");
         return nullptr;
@@ -1,7 +1,7 @@
 #include "solid_model_occ.hpp"
-#include "preferences/preferences.hpp"
-#include "canvas/color_palette.hpp"
 #include "util/fs_util.hpp"
+#include "canvas/triangulated_faces.hpp"
+#include "group/group.hpp"
 
 #include <Quantity_Color.hxx>
 #include <TDocStd_Document.hxx>
@@ -16,6 +16,8 @@
 
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRep_Tool.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools.hxx>
 
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
@@ -60,15 +62,18 @@
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepAlgoAPI_Common.hxx>
+#include <TopTools_ListOfShape.hxx>
 
 #include <cairomm/cairomm.h>
+#include <sstream>
 
 
 namespace dune3d {
 
 class Triangulator {
 public:
-    Triangulator(const TopoDS_Shape &shape, face::Faces &faces);
+    Triangulator(const TopoDS_Shape &shape, face::Faces &faces, double deflection, double angle,
+                 const SolidModelSettings &settings);
 
 
 private:
@@ -85,24 +90,26 @@ private:
     Handle(XCAFDoc_ShapeTool) m_assy;
 
     face::Faces &m_faces;
+    std::vector<TriangulatedFace> m_triangulated_faces;
     face::Color m_default_color;
+    const double m_deflection;
+    const double m_angle;
 };
 
-Triangulator::Triangulator(const TopoDS_Shape &shape, face::Faces &faces) : m_faces(faces)
+Triangulator::Triangulator(const TopoDS_Shape &shape, face::Faces &faces, double deflection, double angle,
+                           const SolidModelSettings &settings)
+    : m_faces(faces), m_deflection(deflection), m_angle(angle)
 {
-    {
-        auto color = Preferences::get().canvas.appearance.get_color(ColorP::SOLID_MODEL);
-        m_default_color.r = color.r;
-        m_default_color.b = color.b;
-        m_default_color.g = color.g;
-    }
+    m_default_color.r = settings.color.r;
+    m_default_color.b = settings.color.b;
+    m_default_color.g = settings.color.g;
+    // mesh all faces at once so that OCC can do so in parallel, processFace
+    // then only needs to mesh faces that didn't get meshed here
+    BRepMesh_IncrementalMesh mesh(shape, m_deflection, Standard_False, m_angle, settings.parallel);
     processNode(shape);
+    convert_triangulated_faces(m_triangulated_faces, m_faces);
 }
 
-#if OCC_VERSION_MAJOR >= 7 && OCC_VERSION_MINOR >= 6
-#define HORIZON_NEW_OCC
-#endif
-
 #define USER_PREC (0.14)
 #define USER_ANGLE (0.52359878)
 
@@ -136,11 +143,11 @@ bool Triangulator::processFace(const TopoDS_Face &face, Quantity_Color *color, c
     Standard_Boolean isTessellate(Standard_False);
     Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
 
-    if (triangulation.IsNull() || triangulation->Deflection() > USER_PREC + Precision::Confusion())
+    if (triangulation.IsNull() || triangulation->Deflection() > m_deflection + Precision::Confusion())
         isTessellate = Standard_True;
 
     if (isTessellate) {
-        BRepMesh_IncrementalMesh IM(face, USER_PREC, Standard_False, USER_ANGLE);
+        BRepMesh_IncrementalMesh IM(face, m_deflection, Standard_False, m_angle);
         triangulation = BRep_Tool::Triangulation(face, loc);
     }
 
@@ -162,15 +169,9 @@ bool Triangulator::processFace(const TopoDS_Face &face, Quantity_Color *color, c
 
     Poly::ComputeNormals(triangulation);
 
-#ifndef HORIZON_NEW_OCC
-    const TColgp_Array1OfPnt &arrPolyNodes = triangulation->Nodes();
-    const Poly_Array1OfTriangle &arrTriangles = triangulation->Triangles();
-    const TShort_Array1OfShortReal &arrNormals = triangulation->Normals();
-#endif
-
-
-    m_faces.emplace_back();
-    auto &face_out = m_faces.back();
+    auto &face_out = m_triangulated_faces.emplace_back();
+    face_out.triangulation = triangulation;
+    face_out.mat = mat;
     if (color) {
         face_out.color.r = color->Red();
         face_out.color.g = color->Green();
@@ -179,64 +180,6 @@ bool Triangulator::processFace(const TopoDS_Face &face, Quantity_Color *color, c
     else {
         face_out.color = m_default_color;
     }
-    face_out.vertices.reserve(triangulation->NbNodes());
-
-    std::map<face::Vertex, std::vector<size_t>> pts_map;
-    for (int i = 1; i <= triangulation->NbNodes(); i++) {
-#ifdef HORIZON_NEW_OCC
-        gp_XYZ v(triangulation->Node(i).Coord());
-#else
-        gp_XYZ v(arrPolyNodes(i).Coord());
-#endif
-        const glm::vec4 vg(v.X(), v.Y(), v.Z(), 1);
-        const auto vt = mat * vg;
-        const face::Vertex vertex(vt.x, vt.y, vt.z);
-        pts_map[vertex].push_back(i - 1);
-        face_out.vertices.push_back(vertex);
-    }
-
-    face_out.normals.reserve(triangulation->NbNodes());
-    for (int i = 1; i <= triangulation->NbNodes(); i++) {
-#ifdef HORIZON_NEW_OCC
-        const auto n = triangulation->Normal(i);
-        glm::vec4 vg(n.X(), n.Y(), n.Z(), 0);
-#else
-        auto offset = (i - 1) * 3 + 1;
-        auto x = arrNormals(offset + 0);
-        auto y = arrNormals(offset + 1);
-        auto z = arrNormals(offset + 2);
-        glm::vec4 vg(x, y, z, 0);
-#endif
-        auto vt = mat * vg;
-        vt /= vt.length();
-        face_out.normals.emplace_back(vt.x, vt.y, vt.z);
-    }
-
-    // average normals at coincident vertices
-    for (const auto &[k, v] : pts_map) {
-        if (v.size() > 1) {
-            face::Vertex n_acc(0, 0, 0);
-            for (const auto idx : v) {
-                n_acc += face_out.normals.at(idx);
-            }
-            n_acc /= v.size();
-            for (const auto idx : v) {
-                face_out.normals.at(idx) = n_acc;
-            }
-        }
-    }
-
-    face_out.triangle_indices.reserve(triangulation->NbTriangles());
-    for (int i = 1; i <= triangulation->NbTriangles(); i++) {
-        int a, b, c;
-#ifdef HORIZON_NEW_OCC
-        triangulation->Triangle(i).Get(a, b, c);
-#else
-        arrTriangles(i).Get(a, b, c);
-#endif
-        face_out.triangle_indices.emplace_back(a - 1, b - 1, c - 1);
-        // std::cout << "tr " << a - 1 << " " << b - 1 << " " << c - 1 << std::endl;
-    }
 
     return true;
 }
@@ -384,7 +327,19 @@ bool Triangulator::processNode(const TopoDS_Shape &shape)
 void SolidModelOcc::triangulate()
 {
     m_faces.clear();
-    Triangulator tri{m_shape_acc, m_faces};
+    Triangulator tri{m_shape_acc, m_faces, USER_PREC, USER_ANGLE, m_settings};
+
+    auto generate = [shape = m_shape_acc, settings = m_settings](float deflection, float angle) {
+        // meshing stores the triangulation in the shape's faces, so mesh a copy
+        // to not interfere with anyone else using the shape
+        BRepBuilderAPI_Copy copy(shape, Standard_False);
+        const auto &shape_copy = copy.Shape();
+        BRepTools::Clean(shape_copy);
+        face::Faces faces;
+        Triangulator tri{shape_copy, faces, deflection, angle, settings};
+        return faces;
+    };
+    m_faces_lod = std::make_unique<face::FacesLOD>(m_faces, generate);
 }
 
 inline double defaultAngularDeflection(double linearTolerance)
@@ -594,19 +549,64 @@ void SolidModelOcc::find_edges()
     }
 }
 
-void SolidModelOcc::update_acc(IGroupSolidModel::Operation op, const TopoDS_Shape &last)
+bool SolidModelOcc::build_boolean(BRepAlgoAPI_BuilderAlgo &op, std::list<GroupStatusMessage> &messages) const
 {
+    op.SetRunParallel(m_settings.parallel);
+    if (m_settings.glue)
+        op.SetGlue(BOPAlgo_GlueShift);
+    op.SetFuzzyValue(m_settings.fuzzy_value);
+    op.Build();
+    if (op.HasErrors()) {
+        std::ostringstream os;
+        op.DumpErrors(os);
+        messages.emplace_back(GroupStatusMessage::Status::ERR, "boolean failed: " + os.str());
+        return false;
+    }
+    if (!op.IsDone()) {
+        messages.emplace_back(GroupStatusMessage::Status::ERR, "boolean failed");
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+static TopoDS_Shape run_boolean(const SolidModelOcc &mod, const TopoDS_Shape &argument, const TopoDS_Shape &tool,
+                                std::list<GroupStatusMessage> &messages)
+{
+    TopTools_ListOfShape arguments;
+    arguments.Append(argument);
+    TopTools_ListOfShape tools;
+    tools.Append(tool);
+
+    T op;
+    op.SetArguments(arguments);
+    op.SetTools(tools);
+    if (!mod.build_boolean(op, messages))
+        return {};
+    return op.Shape();
+}
+
+bool SolidModelOcc::update_acc(IGroupSolidModel::Operation op, const TopoDS_Shape &last,
+                               std::list<GroupStatusMessage> &messages)
+{
+    const auto n_messages = messages.size();
     switch (op) {
     case IGroupSolidModel::Operation::DIFFERENCE:
-        m_shape_acc = BRepAlgoAPI_Cut(last, m_shape);
+        m_shape_acc = run_boolean<BRepAlgoAPI_Cut>(*this, last, m_shape, messages);
         break;
     case IGroupSolidModel::Operation::UNION:
-        m_shape_acc = BRepAlgoAPI_Fuse(last, m_shape);
+        m_shape_acc = run_boolean<BRepAlgoAPI_Fuse>(*this, last, m_shape, messages);
         break;
     case IGroupSolidModel::Operation::INTERSECTION:
-        m_shape_acc = BRepAlgoAPI_Common(last, m_shape);
+        m_shape_acc = run_boolean<BRepAlgoAPI_Common>(*this, last, m_shape, messages);
         break;
     }
+    if (m_shape_acc.IsNull()) {
+        if (messages.size() == n_messages)
+            messages.emplace_back(GroupStatusMessage::Status::ERR, "didn't generate a shape");
+        return false;
+    }
+    return true;
 }
 
 } // namespace dune3d
@@ -1,11 +1,21 @@
 #include "solid_model.hpp"
 #include "group/igroup_solid_model.hpp"
+#include "solid_model_settings.hpp"
 #include <TopoDS.hxx>
+#include <list>
+
+class BRepAlgoAPI_BuilderAlgo;
 
 namespace dune3d {
 
+struct GroupStatusMessage;
+
 class SolidModelOcc : public SolidModel {
 public:
+    explicit SolidModelOcc(const SolidModelSettings &settings) : m_settings(settings)
+    {
+    }
+
     TopoDS_Shape m_shape;
     TopoDS_Shape m_shape_acc;
 
@@ -17,7 +27,15 @@ public:
     void export_projection(const std::filesystem::path &path, const glm::dvec3 &origin,
                            const glm::dquat &normal) const override;
 
-    void update_acc(IGroupSolidModel::Operation op, const TopoDS_Shape &last);
+    // returns false and adds an error to the messages if the boolean failed
+    bool update_acc(IGroupSolidModel::Operation op, const TopoDS_Shape &last, std::list<GroupStatusMessage> &messages);
+
+    // applies the parallel, glue and fuzzy value settings and builds the boolean,
+    // returns false and adds OCC's errors to the messages if it failed
+    bool build_boolean(BRepAlgoAPI_BuilderAlgo &op, std::list<GroupStatusMessage> &messages) const;
+
+private:
+    const SolidModelSettings m_settings;
 };
 
 } // namespace dune3d
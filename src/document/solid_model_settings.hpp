@@ -0,0 +1,26 @@
+#pragma once
+#include "color.hpp"
+
+namespace dune3d {
+
+// Settings for building solid models. The document gets a copy of them from
+// the main thread, so that solid models can be built on other threads without
+// accessing the preferences.
+class SolidModelSettings {
+public:
+    bool parallel = true;
+    bool glue = false;
+    double fuzzy_value = 0;
+    bool log_timing = false;
+    // for faces without a color of their own, same as in the default appearance
+    Color color{0.89, 0.89, 0.89};
+
+    // whether solid models built with the other settings may differ
+    bool affects_solid_models(const SolidModelSettings &other) const
+    {
+        return parallel != other.parallel || glue != other.glue || fuzzy_value != other.fuzzy_value
+               || color.r != other.color.r || color.g != other.color.g || color.b != other.color.b;
+    }
+};
+
+} // namespace dune3d
@@ -8,10 +8,15 @@
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Face.hxx>
 
 #include <gp_Circ.hxx>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
 
 
 namespace dune3d::solid_model_util {
@@ -32,13 +37,26 @@ unsigned int Node::get_pt_for_edge(const Edge &edge) const
     throw std::runtime_error("not an edge of node");
 }
 
-static Node &get_or_create_node(std::list<Node> &nodes, const glm::dvec2 &p)
+Node &Paths::get_or_create_node(const glm::dvec2 &p)
 {
-    for (auto &node : nodes) {
-        if (glm::length(node.p - p) < 1e-6)
-            return node;
+    // cells are twice the tolerance in size, so a node within the tolerance
+    // can only be in one of the up to four cells overlapping the tolerance box
+    constexpr double cell_size = s_node_tolerance * 2;
+    auto cell_of = [](double x) { return static_cast<int64_t>(std::floor(x / cell_size)); };
+    for (auto x = cell_of(p.x - s_node_tolerance); x <= cell_of(p.x + s_node_tolerance); x++) {
+        for (auto y = cell_of(p.y - s_node_tolerance); y <= cell_of(p.y + s_node_tolerance); y++) {
+            auto it = node_cells.find({x, y});
+            if (it == node_cells.end())
+                continue;
+            for (auto node : it->second) {
+                if (glm::length(node->p - p) < s_node_tolerance)
+                    return *node;
+            }
+        }
     }
-    return nodes.emplace_back(p);
+    auto &node = nodes.emplace_back(p);
+    node_cells[{cell_of(p.x), cell_of(p.y)}].push_back(&node);
+    return node;
 }
 
 
@@ -61,8 +79,7 @@ static glm::dvec2 get_pt(const Entity &e, unsigned int pt)
     throw std::runtime_error("unexpected entity");
 }
 
-Edge::Edge(std::list<Node> &nodes, const Entity &e)
-    : from(get_or_create_node(nodes, get_pt(e, 1))), to(get_or_create_node(nodes, get_pt(e, 2))), entity(e)
+Edge::Edge(Node &afrom, Node &ato, const Entity &e) : from(afrom), to(ato), entity(e)
 {
     from.connected_edges.emplace(this, 1);
     to.connected_edges.emplace(this, 2);
@@ -165,6 +182,19 @@ static glm::dvec2 euler(double r, double phi)
     return {r * cos(phi), r * sin(phi)};
 }
 
+// Only used for finding regions, so this doesn't need to be any finer
+// than is necessary to tell them apart.
+unsigned int get_n_segments(double radius, double angle, unsigned int min_segments)
+{
+    constexpr double tolerance = 1e-2;
+    constexpr unsigned int max_segments = 1024;
+    if (radius <= tolerance)
+        return min_segments;
+    const double step = 2 * std::acos(1 - tolerance / radius);
+    const auto segments = static_cast<unsigned int>(std::ceil(std::abs(angle) / step));
+    return std::clamp(segments, min_segments, max_segments);
+}
+
 static Clipper2Lib::PathD path_to_clipper(const Path &path, unsigned int path_index)
 {
     Clipper2Lib::PathD cpath;
@@ -173,7 +203,7 @@ static Clipper2Lib::PathD path_to_clipper(const Path &path, unsigned int path_in
         auto &[node, edge] = path.at(iv);
         if (auto circle = dynamic_cast<const EntityCircle2D *>(&edge.entity)) {
             {
-                const unsigned int segments = 8;
+                const unsigned int segments = get_n_segments(circle->m_radius, 2 * M_PI, 8);
 
                 float dphi = 2 * M_PI;
                 dphi /= segments;
@@ -196,7 +226,6 @@ static Clipper2Lib::PathD path_to_clipper(const Path &path, unsigned int path_in
             const auto radius0 = glm::length(arc->m_center - arc->m_from);
             const auto a0 = c2pi(angle(pc - arc->m_center));
             const auto a1 = c2pi(angle(get_pt(edge.entity, pt == 1 ? 2 : 1) - arc->m_center));
-            const unsigned int segments = 64;
 
             float dphi = c2pi(a1 - a0);
             if (pt == 2) {
@@ -205,6 +234,8 @@ static Clipper2Lib::PathD path_to_clipper(const Path &path, unsigned int path_in
             if (std::abs(dphi) < 1e-2)
                 dphi = 2 * M_PI;
 
+            // at least two segments on either side of the midpoint, see VertexInfo::make_z
+            const unsigned int segments = get_n_segments(radius0, dphi, 4);
             dphi /= segments;
             float a = a0;
             for (unsigned int i = 0; i < segments; i++) {
@@ -443,9 +474,8 @@ FaceBuilder FaceBuilder::from_document(const Document &doc, const UUID &wrkpl_uu
 Paths Paths::from_document(const Document &doc, const UUID &wrkpl_uu, const UUID &source_group_uu)
 {
     Paths paths;
-    for (const auto &[uu, en] : doc.m_entities) {
-        if (en->m_group != source_group_uu)
-            continue;
+    for (const auto &uu : doc.get_group_entities(source_group_uu)) {
+        const auto &en = doc.m_entities.at(uu);
         if (en->m_construction)
             continue;
         if (en->get_type() == Entity::Type::CIRCLE_2D)
@@ -458,14 +488,18 @@ Paths Paths::from_document(const Document &doc, const UUID &wrkpl_uu, const UUID
             if (auto en_line = dynamic_cast<const EntityLine2D *>(en.get()))
                 if (glm::length(en_line->m_p1 - en_line->m_p2) < 1e-6)
                     continue;
-            paths.edges.emplace_back(paths.nodes, *en);
+            auto &from = paths.get_or_create_node(get_pt(*en, 1));
+            auto &to = paths.get_or_create_node(get_pt(*en, 2));
+            paths.edges.emplace_back(from, to, *en);
         }
     }
 
     int tag = 1;
+    // nodes before it have all been visited already, so there's no need to look at them again
+    auto it = paths.nodes.begin();
     while (true) {
         // find a node with tag 0, i.e. hasn't been visited yet
-        auto it = std::ranges::find_if(paths.nodes, [](auto &x) { return x.tag == 0 && x.is_valid(); });
+        it = std::find_if(it, paths.nodes.end(), [](auto &x) { return x.tag == 0 && x.is_valid(); });
         if (it == paths.nodes.end())
             break;
         auto node = &(*it);
@@ -514,9 +548,8 @@ Paths Paths::from_document(const Document &doc, const UUID &wrkpl_uu, const UUID
     }
 
     // add circles
-    for (const auto &[uu, en] : doc.m_entities) {
-        if (en->m_group != source_group_uu)
-            continue;
+    for (const auto &uu : doc.get_group_entities(source_group_uu)) {
+        const auto &en = doc.m_entities.at(uu);
         if (en->m_construction)
             continue;
         if (en->get_type() != Entity::Type::CIRCLE_2D)
@@ -534,4 +567,70 @@ Paths Paths::from_document(const Document &doc, const UUID &wrkpl_uu, const UUID
     return paths;
 }
 
+ProfileFaces::ProfileFaces(const TopoDS_Compound &faces, unsigned int n_faces) : m_faces(faces), m_n_faces(n_faces)
+{
+}
+
+TopoDS_Shape ProfileFaces::get_faces(const gp_Trsf &trsf) const
+{
+    return BRepBuilderAPI_Transform(m_faces, trsf, Standard_True).Shape();
+}
+
+namespace {
+struct ProfileCacheEntry {
+    uint64_t wrkpl_revision;
+    uint64_t source_group_revision;
+    std::shared_ptr<const ProfileFaces> faces;
+    uint64_t last_used;
+};
+} // namespace
+
+std::shared_ptr<const ProfileFaces> ProfileFaces::get(const Document &doc, const UUID &wrkpl_uu,
+                                                      const UUID &source_group_uu)
+{
+    static std::mutex mutex;
+    // by workplane and source group, only the most recent revision of each
+    static std::map<std::pair<UUID, UUID>, ProfileCacheEntry> cache;
+    static uint64_t last_used = 0;
+    static constexpr size_t max_entries = 64;
+
+    const auto &wrkpl = doc.get_entity<EntityWorkplane>(wrkpl_uu);
+    const auto wrkpl_revision = doc.get_group_revision(wrkpl.m_group);
+    const auto source_group_revision = doc.get_group_revision(source_group_uu);
+    // revisions are unique across documents, but groups that haven't changed
+    // since loading don't have one yet
+    const bool cacheable = wrkpl_revision && source_group_revision;
+    const std::pair<UUID, UUID> key{wrkpl_uu, source_group_uu};
+
+    if (cacheable) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (auto it = cache.find(key); it != cache.end()) {
+            auto &entry = it->second;
+            if (entry.wrkpl_revision == wrkpl_revision && entry.source_group_revision == source_group_revision) {
+                entry.last_used = ++last_used;
+                return entry.faces;
+            }
+        }
+    }
+
+    auto face_builder = FaceBuilder::from_document(doc, wrkpl_uu, source_group_uu, glm::dvec3(0, 0, 0));
+    auto faces = std::make_shared<ProfileFaces>(face_builder.get_faces(), face_builder.get_n_faces());
+
+    if (cacheable) {
+        std::lock_guard<std::mutex> guard(mutex);
+        cache.insert_or_assign(key, ProfileCacheEntry{
+                                            .wrkpl_revision = wrkpl_revision,
+                                            .source_group_revision = source_group_revision,
+                                            .faces = faces,
+                                            .last_used = ++last_used,
+                                    });
+        if (cache.size() > max_entries) {
+            auto lru = std::ranges::min_element(cache, {}, [](const auto &it) { return it.second.last_used; });
+            cache.erase(lru);
+        }
+    }
+
+    return faces;
+}
+
 } // namespace dune3d::solid_model_util
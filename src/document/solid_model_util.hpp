@@ -2,9 +2,13 @@
 #include <glm/glm.hpp>
 #include <deque>
 #include <set>
-#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <vector>
 #include "clipper2/clipper.h"
 #include <TopoDS_Builder.hxx>
+#include <gp_Trsf.hxx>
+#include <memory>
 
 
 namespace dune3d {
@@ -31,7 +35,7 @@ public:
 
 class Edge {
 public:
-    Edge(std::list<Node> &nodes, const Entity &e);
+    Edge(Node &from, Node &to, const Entity &e);
     Edge(Node &node, const EntityCircle2D &e);
     Node &from;
     Node &to;
@@ -41,14 +45,32 @@ public:
 
 using Path = std::deque<std::pair<Node &, Edge &>>;
 
+// Number of segments to approximate an arc with when finding regions, so
+// that the segments deviate at most by a fixed tolerance from it
+unsigned int get_n_segments(double radius, double angle, unsigned int min_segments);
+
 class Paths {
 public:
     std::deque<Path> paths;
     static Paths from_document(const Document &doc, const UUID &wrkpl_uu, const UUID &source_group_uu);
 
 private:
-    std::list<Node> nodes;
-    std::list<Edge> edges;
+    // deques so that references to nodes and edges stay valid when adding more
+    std::deque<Node> nodes;
+    std::deque<Edge> edges;
+
+    // nodes by the cell of a grid they're in, for finding the node at a point
+    // without looking at all of them
+    static constexpr double s_node_tolerance = 1e-6;
+    using Cell = std::pair<int64_t, int64_t>;
+    struct CellHash {
+        size_t operator()(const Cell &c) const
+        {
+            return std::hash<int64_t>{}((c.first * 73856093) ^ (c.second * 19349663));
+        }
+    };
+    std::unordered_map<Cell, std::vector<Node *>, CellHash> node_cells;
+    Node &get_or_create_node(const glm::dvec2 &p);
 };
 
 
@@ -81,8 +103,33 @@ private:
 
     TopoDS_Wire path_to_wire(const Clipper2Lib::PathD &path, bool hole);
 };
+
+// Faces built from the paths of a group in a workplane. They're cached by the
+// revisions of the source group and the workplane's group, so that groups
+// sweeping the same sketch and rebuilds that don't change it can reuse them.
+class ProfileFaces {
+public:
+    static std::shared_ptr<const ProfileFaces> get(const Document &doc, const UUID &wrkpl_uu,
+                                                   const UUID &source_group_uu);
+
+    // the cached faces are never handed out directly, so that they can't end
+    // up being modified by solid models that get built concurrently
+    TopoDS_Shape get_faces(const gp_Trsf &trsf = gp_Trsf()) const;
+    unsigned int get_n_faces() const
+    {
+        return m_n_faces;
+    }
+
+    ProfileFaces(const TopoDS_Compound &faces, unsigned int n_faces);
+
+private:
+    TopoDS_Compound m_faces;
+    unsigned int m_n_faces;
+};
+
 } // namespace solid_model_util
 
 using FaceBuilder = solid_model_util::FaceBuilder;
+using ProfileFaces = solid_model_util::ProfileFaces;
 
 } // namespace dune3d
@@ -27,6 +27,7 @@
 #include "system/system.hpp"
 #include "logger/log_util.hpp"
 #include "nlohmann/json.hpp"
+#include "import_step/step_import_manager.hpp"
 #include <iostream>
 
 namespace dune3d {
@@ -73,6 +74,14 @@ void Editor::init()
     m_preferences.signal_changed().connect(sigc::mem_fun(*this, &Editor::apply_preferences));
 
     m_core.signal_tool_changed().connect(sigc::mem_fun(*this, &Editor::handle_tool_change));
+    m_core.signal_solid_models_updated().connect([this] {
+        canvas_update_keep_selection();
+        m_workspace_browser->update_documents(get_current_document_views());
+    });
+    STEPImportManager::get().signal_imported().connect([this](const std::filesystem::path &path) {
+        canvas_update_keep_selection();
+        tool_bar_flash("Imported " + path_to_string(path.filename()));
+    });
 
 
     m_core.signal_documents_changed().connect([this] {
@@ -356,7 +365,7 @@ void Editor::init_canvas()
             "remove_constraint", Glib::Variant<std::string>::variant_type(), [this](Glib::VariantBase const &value) {
                 UUID uu = Glib::VariantBase::cast_dynamic<Glib::Variant<std::string>>(value).get();
                 auto &doc = m_core.get_current_document();
-                doc.m_constraints.erase(uu);
+                doc.erase_constraint(uu);
                 doc.set_group_solve_pending(m_core.get_current_group());
                 m_core.set_needs_save();
                 m_core.rebuild("remove constraint");
@@ -916,8 +925,15 @@ void Editor::apply_preferences()
         get_canvas().set_appearance(m_preferences.canvas.appearance);
     }
     get_canvas().set_enable_animations(m_preferences.canvas.enable_animations);
+    get_canvas().set_enable_culling(m_preferences.canvas.culling);
     get_canvas().set_zoom_to_cursor(m_preferences.canvas.zoom_to_cursor);
     get_canvas().set_rotation_scheme(m_preferences.canvas.rotation_scheme);
+    {
+        // solid models get built on other threads, so they can't look up the color themselves
+        SolidModelSettings settings = m_preferences.solid_model;
+        settings.color = m_preferences.canvas.appearance.get_color(ColorP::SOLID_MODEL);
+        m_core.set_solid_model_settings(settings);
+    }
 
     m_win.tool_bar_set_vertical(m_preferences.tool_bar.vertical_layout);
     update_action_bar_visibility();
@@ -44,6 +44,7 @@ void Editor::on_export_solid_model(const ActionConnection &conn)
             // open_file_view(file);
             //  Notice that this is a std::string, not a Glib::ustring.
             const auto path = path_from_string(append_suffix_if_required(file->get_path(), suffix));
+            m_core.update_solid_models_now();
             auto &group = m_core.get_current_document().get_group(m_core.get_current_group());
             if (auto gr = dynamic_cast<const IGroupSolidModel *>(&group)) {
                 if (action == ActionID::EXPORT_SOLID_MODEL_STEP)
@@ -147,6 +148,7 @@ void Editor::on_export_projection(const ActionConnection &conn)
                     }
                 }
             }
+            m_core.update_solid_models_now();
             auto &group = m_core.get_current_document().get_group(m_core.get_current_group());
             if (auto gr = dynamic_cast<const IGroupSolidModel *>(&group))
                 gr->get_solid_model()->export_projection(path, origin, normal);
@@ -303,6 +303,13 @@ private:
     Gtk::DropDown *m_display_combo = nullptr;
 };
 
+void SelectionEditor::entity_changed(const UUID &entity)
+{
+    auto &doc = m_core.get_current_document();
+    doc.set_group_changed(doc.get_entity(entity).m_group);
+    m_signal_changed.emit();
+}
+
 void SelectionEditor::set_selection(const std::set<SelectableRef> &sel)
 {
     if (m_editor) {
@@ -319,7 +326,7 @@ void SelectionEditor::set_selection(const std::set<SelectableRef> &sel)
             m_title->set_tooltip_text((std::string)wrkpl->entity);
             auto ed = Gtk::make_managed<WorkplaneEditor>(m_core.get_current_document(), wrkpl->entity);
             m_editor = ed;
-            ed->signal_changed().connect([this] { m_signal_changed.emit(); });
+            ed->signal_changed().connect([this, uu = wrkpl->entity] { entity_changed(uu); });
         }
         else if (auto step = entity_and_point_from_selection(m_core.get_current_document(), sel, Entity::Type::STEP)) {
             m_title->set_label("STEP");
@@ -327,7 +334,7 @@ void SelectionEditor::set_selection(const std::set<SelectableRef> &sel)
             auto ed = Gtk::make_managed<STEPEditor>(m_core.get_current_document_directory(),
                                                     m_core.get_current_document().get_entity<EntitySTEP>(step->entity));
             m_editor = ed;
-            ed->signal_changed().connect([this] { m_signal_changed.emit(); });
+            ed->signal_changed().connect([this, uu = step->entity] { entity_changed(uu); });
 
             auto ved =
                     Gtk::make_managed<EntityViewEditorSTEP>(m_doc_view_prv.get_current_document_view(), step->entity);
@@ -342,7 +349,7 @@ void SelectionEditor::set_selection(const std::set<SelectableRef> &sel)
                     m_core.get_current_document_directory(),
                     m_core.get_current_document().get_entity<EntityDocument>(doc->entity));
             m_editor = ed;
-            ed->signal_changed().connect([this] { m_signal_changed.emit(); });
+            ed->signal_changed().connect([this, uu = doc->entity] { entity_changed(uu); });
         }
         else if (sel.size()) {
             m_title->set_label("");
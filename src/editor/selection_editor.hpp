@@ -27,5 +27,7 @@ private:
     Gtk::Label *m_title = nullptr;
 
     type_signal_changed m_signal_view_changed;
+
+    void entity_changed(const UUID &entity);
 };
 } // namespace dune3d
@@ -1,10 +1,14 @@
 #pragma once
 #include "canvas/face.hpp"
+#include "canvas/faces_lod.hpp"
 #include <deque>
 #include <string>
 #include <vector>
 #include <tuple>
 #include <filesystem>
+#include <map>
+#include <functional>
+#include <stdexcept>
 
 namespace dune3d::STEPImporter {
 using namespace dune3d::face;
@@ -15,7 +19,17 @@ class Result {
 public:
     Faces faces;
     std::deque<Point> points;
+    // coarser meshes of faces, by FacesLOD level
+    std::map<unsigned int, Faces> lod_faces;
 };
 
-Result import(const std::filesystem::path &filename);
+// thrown by import once cancelled returns true, which gets checked between shapes
+class Cancelled : public std::runtime_error {
+public:
+    Cancelled() : std::runtime_error("import cancelled")
+    {
+    }
+};
+
+Result import(const std::filesystem::path &filename, std::function<bool()> cancelled = nullptr);
 } // namespace dune3d::STEPImporter
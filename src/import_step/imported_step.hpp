@@ -2,6 +2,7 @@
 #include "import.hpp"
 #include <filesystem>
 #include <atomic>
+#include <memory>
 
 namespace dune3d {
 class ImportedSTEP {
@@ -10,8 +11,9 @@ public:
     {
     }
 
-    std::atomic_bool ready;
+    std::atomic_bool ready = false;
     const std::filesystem::path path;
     STEPImporter::Result result;
+    std::unique_ptr<face::FacesLOD> faces_lod;
 };
 } // namespace dune3d
@@ -5,6 +5,9 @@
 #include <glibmm.h>
 #include <giomm.h>
 #include "util/fs_util.hpp"
+#include "logger/logger.hpp"
+#include <chrono>
+#include <format>
 
 namespace dune3d {
 
@@ -25,6 +28,16 @@ static void create_cache_dir()
 STEPImportManager::STEPImportManager()
 {
     create_cache_dir();
+    m_dispatcher.connect([this] {
+        std::deque<std::filesystem::path> done;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            std::swap(done, m_done);
+        }
+        for (const auto &path : done)
+            m_signal_imported.emit(path);
+    });
+    m_thread = std::thread(&STEPImportManager::worker_thread, this);
 }
 
 STEPImportManager &STEPImportManager::get()
@@ -105,7 +118,7 @@ namespace STEPImporter {
 
 static void to_json(json &j, const Result &r)
 {
-    j = {{"faces", r.faces}, {"points", r.points}};
+    j = {{"faces", r.faces}, {"points", r.points}, {"lod_faces", r.lod_faces}};
 }
 
 static void from_json(const json &j, Result &r)
@@ -113,39 +126,118 @@ static void from_json(const json &j, Result &r)
 
     j.at("points").get_to(r.points);
     j.at("faces").get_to(r.faces);
+    // not in caches from before there were levels of detail
+    if (j.contains("lod_faces"))
+        j.at("lod_faces").get_to(r.lod_faces);
 }
 
 } // namespace STEPImporter
 
 
-std::shared_ptr<ImportedSTEP> STEPImportManager::import_step(const std::filesystem::path &path)
+static void import_from_file_or_cache(ImportedSTEP &imported, const std::function<bool()> &cancelled)
 {
-    if (m_imported.contains(path))
-        return m_imported.at(path);
-
-    auto imported = std::make_shared<ImportedSTEP>(path);
-    imported->ready = true;
+    const auto &path = imported.path;
+    const auto filename = path_to_string(path.filename());
 
     auto hash = hash_file(path);
     auto cache_path = get_cache_dir() / (hash + ".ubjson");
 
     if (fs::exists(cache_path)) {
-        // json::from_ubjson(
         auto rd = Glib::file_get_contents(cache_path.string());
         auto j = json::from_ubjson(std::span(rd.data(), rd.size()));
-        j.get_to(imported->result);
+        j.get_to(imported.result);
+        Logger::log_info("loaded " + filename + " from cache", Logger::Domain::IMPORT);
     }
     else {
-        imported->result = STEPImporter::import(path.generic_string());
-
-        json j = imported->result;
+        Logger::log_info("importing " + filename, Logger::Domain::IMPORT);
+        const auto t_start = std::chrono::steady_clock::now();
+        imported.result = STEPImporter::import(path.generic_string(), cancelled);
+        const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t_start;
+        Logger::log_info(std::format("imported {} in {:.1f}s, {} faces", filename, dt.count(),
+                                     imported.result.faces.size()),
+                         Logger::Domain::IMPORT);
+
+        json j = imported.result;
         auto bs = json::to_ubjson(j);
         Glib::file_set_contents(cache_path.string(), reinterpret_cast<const gchar *>(bs.data()), bs.size());
-        // save_json_to_file(cache_path, j);
     }
-    m_imported.emplace(path, imported);
+
+    imported.faces_lod = std::make_unique<face::FacesLOD>(imported.result.faces);
+    for (auto &[level, faces] : imported.result.lod_faces)
+        imported.faces_lod->set_level(level, std::move(faces));
+    imported.result.lod_faces.clear();
+}
+
+void STEPImportManager::worker_thread()
+{
+    while (true) {
+        std::shared_ptr<ImportedSTEP> imported;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_exit || m_queue.size(); });
+            if (m_exit)
+                return;
+            imported = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        try {
+            // so that quitting doesn't need to wait for the import to finish
+            import_from_file_or_cache(*imported, [this] {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_exit;
+            });
+        }
+        catch (const STEPImporter::Cancelled &) {
+            return;
+        }
+        catch (const std::exception &e) {
+            Logger::log_critical("error importing " + path_to_string(imported->path), Logger::Domain::IMPORT,
+                                 e.what());
+        }
+        catch (const Glib::Error &e) {
+            Logger::log_critical("error importing " + path_to_string(imported->path), Logger::Domain::IMPORT,
+                                 e.what());
+        }
+        catch (...) {
+            Logger::log_critical("error importing " + path_to_string(imported->path), Logger::Domain::IMPORT,
+                                 "unknown error");
+        }
+        imported->ready = true;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_done.push_back(imported->path);
+        }
+        m_dispatcher.emit();
+    }
+}
+
+std::shared_ptr<ImportedSTEP> STEPImportManager::import_step(const std::filesystem::path &path)
+{
+    std::shared_ptr<ImportedSTEP> imported;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_imported.contains(path))
+            return m_imported.at(path);
+
+        imported = std::make_shared<ImportedSTEP>(path);
+        m_imported.emplace(path, imported);
+        m_queue.push_back(imported);
+    }
+    m_cond.notify_one();
     return imported;
 }
 
+STEPImportManager::~STEPImportManager()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_exit = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
 
 } // namespace dune3d
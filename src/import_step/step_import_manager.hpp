@@ -1,7 +1,12 @@
 #pragma once
+#include <glibmm/dispatcher.h>
+#include <sigc++/sigc++.h>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <map>
+#include <thread>
 #include "imported_step.hpp"
 
 namespace dune3d {
@@ -9,11 +14,35 @@ namespace dune3d {
 class STEPImportManager {
 public:
     static STEPImportManager &get();
+
+    // Returns immediately, the import itself runs in a background thread.
+    // ImportedSTEP::ready gets set once the result is available.
     std::shared_ptr<ImportedSTEP> import_step(const std::filesystem::path &path);
 
+    // Emitted on the main thread after an import has finished
+    using type_signal_imported = sigc::signal<void(const std::filesystem::path &path)>;
+    type_signal_imported signal_imported()
+    {
+        return m_signal_imported;
+    }
+
+    ~STEPImportManager();
+
 private:
     STEPImportManager();
     std::map<std::filesystem::path, std::shared_ptr<ImportedSTEP>> m_imported;
+
+    void worker_thread();
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::shared_ptr<ImportedSTEP>> m_queue;
+    std::deque<std::filesystem::path> m_done;
+    bool m_exit = false;
+
+    Glib::Dispatcher m_dispatcher;
+    type_signal_imported m_signal_imported;
+    std::thread m_thread;
 };
 
 } // namespace dune3d
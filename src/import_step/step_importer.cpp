@@ -14,6 +14,9 @@
 
 #include <STEPCAFControl_Reader.hxx>
 #include <STEPControl_Reader.hxx>
+#if OCC_VERSION_HEX >= 0x070500
+#include <Message_ProgressIndicator.hxx>
+#endif
 
 #include <XCAFDoc_ColorTool.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
@@ -21,6 +24,7 @@
 
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRep_Tool.hxx>
+#include <BRepTools.hxx>
 
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
@@ -60,6 +64,29 @@ namespace dune3d::STEPImporter {
 // https://github.com/KiCad/kicad-source-mirror/blob/master/plugins/3d/oce/loadmodel.cpp
 
 
+#if OCC_VERSION_HEX >= 0x070500
+// lets OCC stop transferring shapes once the import has been cancelled
+class CancelIndicator : public Message_ProgressIndicator {
+public:
+    CancelIndicator(const std::function<bool()> &cancelled) : m_cancelled(cancelled)
+    {
+    }
+
+    Standard_Boolean UserBreak() override
+    {
+        return m_cancelled && m_cancelled();
+    }
+
+protected:
+    void Show(const Message_ProgressScope &scope, const Standard_Boolean force) override
+    {
+    }
+
+private:
+    const std::function<bool()> &m_cancelled;
+};
+#endif
+
 bool STEPImporter::readSTEP(const char *fname)
 {
     STEPCAFControl_Reader reader;
@@ -82,7 +109,13 @@ bool STEPImporter::readSTEP(const char *fname)
     reader.SetNameMode(false);  // don't use label names
     reader.SetLayerMode(false); // ignore LAYER data
 
-    if (!reader.Transfer(m_doc)) {
+#if OCC_VERSION_HEX >= 0x070500
+    Handle(CancelIndicator) indicator = new CancelIndicator(m_cancelled);
+    const bool transferred = reader.Transfer(m_doc, indicator->Start());
+#else
+    const bool transferred = reader.Transfer(m_doc);
+#endif
+    if (!transferred) {
         m_doc->Close();
         return false;
     }
@@ -95,7 +128,8 @@ bool STEPImporter::readSTEP(const char *fname)
 }
 
 
-STEPImporter::STEPImporter(const std::filesystem::path &filename)
+STEPImporter::STEPImporter(const std::filesystem::path &filename, std::function<bool()> cancelled)
+    : m_deflection(USER_PREC), m_angle(USER_ANGLE), m_cancelled(std::move(cancelled))
 {
     m_app = XCAFApp_Application::GetApplication();
 
@@ -139,10 +173,6 @@ void STEPImporter::processWire(const TopoDS_Wire &wire, const glm::dmat4 &mat)
     }
 }
 
-#if OCC_VERSION_MAJOR >= 7 && OCC_VERSION_MINOR >= 6
-#define HORIZON_NEW_OCC
-#endif
-
 bool STEPImporter::processFace(const TopoDS_Face &face, Quantity_Color *color, const glm::dmat4 &mat)
 {
     if (Standard_True == face.IsNull())
@@ -168,11 +198,11 @@ bool STEPImporter::processFace(const TopoDS_Face &face, Quantity_Color *color, c
     Standard_Boolean isTessellate(Standard_False);
     Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
 
-    if (triangulation.IsNull() || triangulation->Deflection() > USER_PREC + Precision::Confusion())
+    if (triangulation.IsNull() || triangulation->Deflection() > m_deflection + Precision::Confusion())
         isTessellate = Standard_True;
 
     if (isTessellate) {
-        BRepMesh_IncrementalMesh IM(face, USER_PREC, Standard_False, USER_ANGLE);
+        BRepMesh_IncrementalMesh IM(face, m_deflection, Standard_False, m_angle);
         triangulation = BRep_Tool::Triangulation(face, loc);
     }
 
@@ -194,15 +224,9 @@ bool STEPImporter::processFace(const TopoDS_Face &face, Quantity_Color *color, c
 
     Poly::ComputeNormals(triangulation);
 
-#ifndef HORIZON_NEW_OCC
-    const TColgp_Array1OfPnt &arrPolyNodes = triangulation->Nodes();
-    const Poly_Array1OfTriangle &arrTriangles = triangulation->Triangles();
-    const TShort_Array1OfShortReal &arrNormals = triangulation->Normals();
-#endif
-
-
-    result->faces.emplace_back();
-    auto &face_out = result->faces.back();
+    auto &face_out = m_triangulated_faces.emplace_back();
+    face_out.triangulation = triangulation;
+    face_out.mat = mat;
     if (color) {
         face_out.color.r = color->Red();
         face_out.color.g = color->Green();
@@ -211,63 +235,6 @@ bool STEPImporter::processFace(const TopoDS_Face &face, Quantity_Color *color, c
     else {
         face_out.color = {0.5, 0.5, 0.5};
     }
-    face_out.vertices.reserve(triangulation->NbNodes());
-
-    std::map<Vertex, std::vector<size_t>> pts_map;
-    for (int i = 1; i <= triangulation->NbNodes(); i++) {
-#ifdef HORIZON_NEW_OCC
-        gp_XYZ v(triangulation->Node(i).Coord());
-#else
-        gp_XYZ v(arrPolyNodes(i).Coord());
-#endif
-        const glm::vec4 vg(v.X(), v.Y(), v.Z(), 1);
-        const auto vt = mat * vg;
-        const Vertex vertex(vt.x, vt.y, vt.z);
-        pts_map[vertex].push_back(i - 1);
-        face_out.vertices.push_back(vertex);
-    }
-
-    face_out.normals.reserve(triangulation->NbNodes());
-    for (int i = 1; i <= triangulation->NbNodes(); i++) {
-#ifdef HORIZON_NEW_OCC
-        const auto n = triangulation->Normal(i);
-        glm::vec4 vg(n.X(), n.Y(), n.Z(), 0);
-#else
-        auto offset = (i - 1) * 3 + 1;
-        auto x = arrNormals(offset + 0);
-        auto y = arrNormals(offset + 1);
-        auto z = arrNormals(offset + 2);
-        glm::vec4 vg(x, y, z, 0);
-#endif
-        auto vt = mat * vg;
-        vt /= vt.length();
-        face_out.normals.emplace_back(vt.x, vt.y, vt.z);
-    }
-
-    // average normals at coincident vertices
-    for (const auto &[k, v] : pts_map) {
-        if (v.size() > 1) {
-            Vertex n_acc(0, 0, 0);
-            for (const auto idx : v) {
-                n_acc += face_out.normals.at(idx);
-            }
-            n_acc /= v.size();
-            for (const auto idx : v) {
-                face_out.normals.at(idx) = n_acc;
-            }
-        }
-    }
-
-    face_out.triangle_indices.reserve(triangulation->NbTriangles());
-    for (int i = 1; i <= triangulation->NbTriangles(); i++) {
-        int a, b, c;
-#ifdef HORIZON_NEW_OCC
-        triangulation->Triangle(i).Get(a, b, c);
-#else
-        arrTriangles(i).Get(a, b, c);
-#endif
-        face_out.triangle_indices.emplace_back(a - 1, b - 1, c - 1);
-    }
 
     return true;
 }
@@ -439,6 +406,12 @@ bool STEPImporter::processNode(const TopoDS_Shape &shape)
     return ret;
 }
 
+void STEPImporter::check_cancelled() const
+{
+    if (m_cancelled && m_cancelled())
+        throw Cancelled();
+}
+
 Result STEPImporter::get_faces_and_points()
 {
     Result res;
@@ -451,15 +424,35 @@ Result STEPImporter::get_faces_and_points()
     int id = 1;
     std::cout << "shapes " << nshapes << std::endl;
     while (id <= nshapes) {
+        check_cancelled();
         TopoDS_Shape shape = m_assy->GetShape(frshapes.Value(id));
-        if (!shape.IsNull() && processNode(shape)) {
+        if (!shape.IsNull()) {
+            // mesh all faces at once so that OCC can do so in parallel
+            BRepMesh_IncrementalMesh mesh(shape, m_deflection, Standard_False, m_angle, Standard_True);
+            processNode(shape);
         }
         ++id;
     }
+    convert_triangulated_faces(m_triangulated_faces, res.faces);
+    m_triangulated_faces.clear();
     result = nullptr;
     return res;
 }
 
+Faces STEPImporter::get_faces(double deflection, double angle)
+{
+    // coarser meshes than the existing ones wouldn't be created otherwise
+    for (const auto &shape : get_shapes())
+        BRepTools::Clean(shape);
+
+    m_deflection = deflection;
+    m_angle = angle;
+    auto res = get_faces_and_points();
+    m_deflection = USER_PREC;
+    m_angle = USER_ANGLE;
+    return std::move(res.faces);
+}
+
 std::vector<TopoDS_Shape> STEPImporter::get_shapes()
 {
     std::vector<TopoDS_Shape> r;
@@ -479,12 +472,22 @@ std::vector<TopoDS_Shape> STEPImporter::get_shapes()
     return r;
 }
 
-Result import(const std::filesystem::path &filename)
+Result import(const std::filesystem::path &filename, std::function<bool()> cancelled)
 {
-    STEPImporter importer(filename);
+    STEPImporter importer(filename, cancelled);
+    // transferring the shapes stops early once cancelled, so it's not loaded then
+    if (cancelled && cancelled())
+        throw Cancelled();
     if (!importer.is_loaded())
         return {};
-    return importer.get_faces_and_points();
+    auto result = importer.get_faces_and_points();
+    for (unsigned int level = FacesLOD::s_base_level + 1; level < FacesLOD::s_n_levels; level++) {
+        if (cancelled && cancelled())
+            throw Cancelled();
+        result.lod_faces.emplace(level,
+                                 importer.get_faces(FacesLOD::get_deflection(level), FacesLOD::get_angle(level)));
+    }
+    return result;
 }
 
 } // namespace dune3d::STEPImporter
@@ -1,5 +1,6 @@
 #pragma once
 #include "import.hpp"
+#include "canvas/triangulated_faces.hpp"
 #include <TDocStd_Document.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Face.hxx>
@@ -13,9 +14,11 @@
 namespace dune3d::STEPImporter {
 class STEPImporter {
 public:
-    STEPImporter(const std::filesystem::path &filename);
+    STEPImporter(const std::filesystem::path &filename, std::function<bool()> cancelled = nullptr);
 
     Result get_faces_and_points();
+    // meshes the faces again with the given tolerances
+    Faces get_faces(double deflection, double angle);
     bool is_loaded() const
     {
         return loaded;
@@ -31,6 +34,7 @@ private:
     bool processShell(const TopoDS_Shape &shape, Quantity_Color *color, const glm::dmat4 &mat = glm::dmat4(1));
     bool processFace(const TopoDS_Face &face, Quantity_Color *color, const glm::dmat4 &mat = glm::dmat4(1));
     void processWire(const TopoDS_Wire &wire, const glm::dmat4 &mat);
+    void check_cancelled() const;
 
     Handle(XCAFApp_Application) m_app;
     Handle(TDocStd_Document) m_doc;
@@ -38,7 +42,11 @@ private:
     Handle(XCAFDoc_ShapeTool) m_assy;
     bool hasSolid;
     bool loaded = false;
+    double m_deflection;
+    double m_angle;
+    std::function<bool()> m_cancelled;
 
     Result *result;
+    std::vector<TriangulatedFace> m_triangulated_faces;
 };
 } // namespace dune3d::STEPImporter
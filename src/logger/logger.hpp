@@ -4,6 +4,7 @@
 #include <string>
 #include <tuple>
 #include <cstdint>
+#include <atomic>
 
 namespace dune3d {
 class Logger {
@@ -57,6 +58,7 @@ public:
 private:
     log_handler_t handler = nullptr;
     std::deque<Item> buffer;
-    uint64_t seq = 0;
+    // items may get logged from worker threads, see LogDispatcher
+    std::atomic<uint64_t> seq = 0;
 };
 } // namespace dune3d
@@ -179,6 +179,36 @@ void ToolBarPreferences::load_from_json(const json &j)
     vertical_layout = j.value("vertical_layout", false);
 }
 
+json DocumentPreferences::serialize() const
+{
+    json j;
+    j["binary_format"] = binary_format;
+    return j;
+}
+
+void DocumentPreferences::load_from_json(const json &j)
+{
+    binary_format = j.value("binary_format", false);
+}
+
+json SolidModelPreferences::serialize() const
+{
+    json j;
+    j["parallel"] = parallel;
+    j["glue"] = glue;
+    j["fuzzy_value"] = fuzzy_value;
+    j["log_timing"] = log_timing;
+    return j;
+}
+
+void SolidModelPreferences::load_from_json(const json &j)
+{
+    parallel = j.value("parallel", true);
+    glue = j.value("glue", false);
+    fuzzy_value = j.value("fuzzy_value", 0.);
+    log_timing = j.value("log_timing", false);
+}
+
 
 #define COLORP_LUT_ITEM(x)                                                                                             \
     {                                                                                                                  \
@@ -225,6 +255,7 @@ json CanvasPreferences::serialize() const
     j["line_width"] = appearance.line_width;
     j["selection_glow"] = appearance.selection_glow;
     j["enable_animations"] = enable_animations;
+    j["culling"] = culling;
     j["theme"] = theme;
     j["theme_variant"] = theme_variant_lut.lookup_reverse(theme_variant);
     j["dark_theme"] = dark_theme;
@@ -277,6 +308,7 @@ void CanvasPreferences::load_from_json(const json &j)
     appearance.line_width = j.value("line_width", 2.5);
     appearance.selection_glow = j.value("selection_glow", true);
     enable_animations = j.value("enable_animations", true);
+    culling = j.value("culling", true);
     theme = j.value("theme", "Default");
     if (j.contains("theme_variant"))
         theme_variant = theme_variant_lut.lookup(j.at("theme_variant"), ThemeVariant::AUTO);
@@ -297,6 +329,8 @@ json Preferences::serialize() const
     j["action_bar"] = action_bar.serialize();
     j["tool_bar"] = tool_bar.serialize();
     j["canvas"] = canvas.serialize();
+    j["document"] = document.serialize();
+    j["solid_model"] = solid_model.serialize();
     return j;
 }
 
@@ -326,6 +360,12 @@ void Preferences::load_from_json(const json &j)
 
     if (j.count("tool_bar"))
         tool_bar.load_from_json(j.at("tool_bar"));
+
+    if (j.count("document"))
+        document.load_from_json(j.at("document"));
+
+    if (j.count("solid_model"))
+        solid_model.load_from_json(j.at("solid_model"));
 }
 
 void Preferences::load()
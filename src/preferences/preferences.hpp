@@ -7,6 +7,7 @@
 #include "util/changeable.hpp"
 #include "canvas/appearance.hpp"
 #include "canvas/rotation_scheme.hpp"
+#include "document/solid_model_settings.hpp"
 
 namespace dune3d {
 using json = nlohmann::json;
@@ -20,6 +21,7 @@ public:
     Appearance appearance;
 
     bool enable_animations = true;
+    bool culling = true;
     bool error_overlay = true;
     bool dark_theme = false;
     bool zoom_to_cursor = true;
@@ -71,6 +73,20 @@ public:
     json serialize() const;
 };
 
+class DocumentPreferences {
+public:
+    bool binary_format = false;
+
+    void load_from_json(const json &j);
+    json serialize() const;
+};
+
+class SolidModelPreferences : public SolidModelSettings {
+public:
+    void load_from_json(const json &j);
+    json serialize() const;
+};
+
 class Preferences : public Changeable {
 public:
     static const Preferences &get();
@@ -90,6 +106,8 @@ public:
     InToolKeySequencesPreferences in_tool_key_sequences;
     ToolBarPreferences tool_bar;
     CanvasPreferences canvas;
+    DocumentPreferences document;
+    SolidModelPreferences solid_model;
 
 private:
     fs::path filename;
@@ -37,6 +37,12 @@ MiscPreferencesEditor::MiscPreferencesEditor(Preferences &prefs) : m_preferences
                     m_preferences, m_preferences.canvas.error_overlay);
             gr->add_row(*r);
         }
+        {
+            auto r = Gtk::make_managed<PreferencesRowBool>(
+                    "Cull hidden geometry", "Skip drawing items that are off screen or too small to be seen",
+                    m_preferences, m_preferences.canvas.culling);
+            gr->add_row(*r);
+        }
         {
             auto r = Gtk::make_managed<PreferencesRowBoolButton>("Zoom center", "Where to zoom with mouse or touchpad",
                                                                  "Cursor", "Screen center", m_preferences,
@@ -87,6 +93,51 @@ MiscPreferencesEditor::MiscPreferencesEditor(Preferences &prefs) : m_preferences
             gr->add_row(*r);
         }
     }
+    {
+        auto gr = Gtk::make_managed<PreferencesGroup>("Documents");
+        box->append(*gr);
+        {
+            auto r = Gtk::make_managed<PreferencesRowBool>(
+                    "Save new documents in binary format",
+                    "CBOR files are smaller and faster to load, but can't be read or diffed as text", m_preferences,
+                    m_preferences.document.binary_format);
+            gr->add_row(*r);
+        }
+    }
+    {
+        auto gr = Gtk::make_managed<PreferencesGroup>("Solid Model");
+        box->append(*gr);
+        {
+            auto r = Gtk::make_managed<PreferencesRowBool>(
+                    "Parallel operations", "Run booleans and meshing on multiple threads", m_preferences,
+                    m_preferences.solid_model.parallel);
+            gr->add_row(*r);
+        }
+        {
+            auto r = Gtk::make_managed<PreferencesRowBool>(
+                    "Glue coincident faces",
+                    "Speeds up booleans of bodies that only touch, may give wrong results if they intersect",
+                    m_preferences, m_preferences.solid_model.glue);
+            gr->add_row(*r);
+        }
+        {
+            auto r = Gtk::make_managed<PreferencesRowNumeric<double>>(
+                    "Fuzzy value", "Additional tolerance in mm for booleans of nearly coincident faces", m_preferences,
+                    m_preferences.solid_model.fuzzy_value);
+            auto &sp = r->get_spinbutton();
+            sp.set_digits(4);
+            sp.set_range(0, 1);
+            sp.set_increments(1e-4, 1e-3);
+            r->bind();
+            gr->add_row(*r);
+        }
+        {
+            auto r = Gtk::make_managed<PreferencesRowBool>("Log timing",
+                                                           "Log how long updating each group's solid model took",
+                                                           m_preferences, m_preferences.solid_model.log_timing);
+            gr->add_row(*r);
+        }
+    }
     {
         auto gr = Gtk::make_managed<PreferencesGroup>("Appearance");
         box->append(*gr);
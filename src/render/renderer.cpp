@@ -56,9 +56,12 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
 
 
     if (m_solid_model_edge_select_mode) {
-        auto last_solid_model = SolidModel::get_last_solid_model(*m_doc, *m_current_group);
-        if (last_solid_model) {
-            m_ca.add_face_group(last_solid_model->m_faces, {0, 0, 0}, glm::quat_identity<float, glm::defaultp>(),
+        auto last_solid_model_group = SolidModel::get_last_solid_model_group(*m_doc, *m_current_group);
+        if (last_solid_model_group) {
+            const auto last_solid_model = last_solid_model_group->get_solid_model();
+            m_ca.add_face_group(std::shared_ptr<const face::FacesLOD>(last_solid_model,
+                                                                      last_solid_model->m_faces_lod.get()),
+                                {0, 0, 0}, glm::quat_identity<float, glm::defaultp>(),
                                 ICanvas::FaceColor::SOLID_MODEL);
             for (const auto &[edge_idx, path] : last_solid_model->m_edges) {
                 for (size_t i = 1; i < path.size(); i++) {
@@ -77,10 +80,14 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
     for (auto group : doc.get_groups_sorted() | std::views::reverse) {
         if (!group_is_visible(group->m_uuid))
             continue;
-        for (const auto &[uu, el] : doc.m_entities) {
-            if (el->m_group == group->m_uuid)
-                render(*el);
+        const auto chunk_key = get_chunk_key(*group, sr);
+        if (chunk_key && !m_ca.begin_chunk(*chunk_key))
+            continue;
+        for (const auto &uu : doc.get_group_entities(group->m_uuid)) {
+            render(*doc.m_entities.at(uu));
         }
+        if (chunk_key)
+            m_ca.end_chunk();
     }
 
 
@@ -88,7 +95,7 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
     for (auto body_groups : groups_by_body) {
         if (!m_doc_view->body_solid_model_is_visible(body_groups.get_group().m_uuid))
             continue;
-        const SolidModel *last_solid_model = nullptr;
+        std::shared_ptr<const SolidModel> last_solid_model;
         for (auto group : body_groups.groups) {
             if (!group_is_visible(group->m_uuid))
                 continue;
@@ -105,8 +112,10 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
                     body_groups.groups, [current_group](auto group) { return group->m_uuid == current_group; });
             const auto color =
                     is_current ? ICanvas::FaceColor::SOLID_MODEL : ICanvas::FaceColor::OTHER_BODY_SOLID_MODEL;
-            const auto vref = m_ca.add_face_group(last_solid_model->m_faces, {0, 0, 0},
-                                                  glm::quat_identity<float, glm::defaultp>(), color);
+            const auto vref =
+                    m_ca.add_face_group(std::shared_ptr<const face::FacesLOD>(last_solid_model,
+                                                                              last_solid_model->m_faces_lod.get()),
+                                        {0, 0, 0}, glm::quat_identity<float, glm::defaultp>(), color);
             if (sr)
                 m_ca.add_selectable(vref, *sr);
         }
@@ -114,11 +123,8 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
 
 
     if (!sr) {
-        for (const auto &[uu, el] : doc.m_constraints) {
-
-            if (m_current_group->m_uuid != el->m_group)
-                continue;
-            el->accept(*this);
+        for (const auto &uu : doc.get_group_constraints(m_current_group->m_uuid)) {
+            doc.m_constraints.at(uu)->accept(*this);
         }
         draw_constraints();
     }
@@ -132,6 +138,37 @@ void Renderer::render(const Document &doc, const UUID &current_group, const IDoc
         m_ca.unset_override_selectable();
 }
 
+std::optional<UUID> Renderer::get_chunk_key(const Group &group, const std::optional<SelectableRef> &sr) const
+{
+    // tools modify the current group's entities without always marking it as changed
+    if (m_is_current_document && &group == m_current_group)
+        return {};
+
+    const auto revision = m_doc->get_group_revision(group.m_uuid);
+    if (!revision)
+        return {};
+
+    std::string extra = std::to_string(revision) + (m_is_current_document ? "c" : "");
+    for (const auto &uu : m_doc->get_group_entities(group.m_uuid)) {
+        const auto &en = *m_doc->m_entities.at(uu);
+        // depends on other documents
+        if (en.of_type(Entity::Type::DOCUMENT))
+            return {};
+        // depends on the import and the view
+        if (auto step = dynamic_cast<const EntitySTEP *>(&en)) {
+            extra += std::format(" {} {} {}", step->m_imported && step->m_imported->ready, step->m_show_points,
+                                 static_cast<int>(get_step_display(*step)));
+        }
+    }
+
+    std::vector<UUID> uuids = {m_chunk_salt, group.m_uuid, m_current_group->m_uuid, m_current_group->m_active_wrkpl};
+    if (sr)
+        uuids.push_back(sr->item);
+
+    return hash_uuids("8c4d1e2a-6f0b-4a53-9d6e-2b7f3c1a9e54", uuids,
+                      {reinterpret_cast<const uint8_t *>(extra.data()), extra.size()});
+}
+
 void Renderer::render(const Entity &entity)
 {
     if (!entity.m_visible)
@@ -353,6 +390,13 @@ void Renderer::visit(const EntityWorkplane &wrkpl)
     }
 }
 
+EntityViewSTEP::Display Renderer::get_step_display(const EntitySTEP &en) const
+{
+    if (auto view = dynamic_cast<const EntityViewSTEP *>(m_doc_view->get_entity_view(en.m_uuid)))
+        return view->m_display;
+    return EntityViewSTEP::Display::SOLID;
+}
+
 void Renderer::visit(const EntitySTEP &en)
 {
     m_ca.add_selectable(m_ca.draw_point(en.m_origin), SelectableRef{SelectableRef::Type::ENTITY, en.m_uuid, 1});
@@ -364,16 +408,25 @@ void Renderer::visit(const EntitySTEP &en)
         }
     }
 
-    auto view = dynamic_cast<const EntityViewSTEP *>(m_doc_view->get_entity_view(en.m_uuid));
-    auto display = EntityViewSTEP::Display::SOLID;
-    if (view)
-        display = view->m_display;
+    const auto display = get_step_display(en);
 
-    if (en.m_imported) {
-        if (display == EntityViewSTEP::Display::SOLID)
-            m_ca.add_selectable(m_ca.add_face_group(en.m_imported->result.faces, en.m_origin, en.m_normal,
-                                                    ICanvas::FaceColor::AS_IS),
-                                SelectableRef{SelectableRef::Type::ENTITY, en.m_uuid, 0});
+    if (en.m_imported && !en.m_imported->ready) {
+        add_selectables(SelectableRef{SelectableRef::Type::ENTITY, en.m_uuid, 0},
+                        m_ca.draw_bitmap_text(en.m_origin, 1, path_to_string(en.m_path.filename()) + " importing"));
+    }
+    else if (en.m_imported) {
+        if (display == EntityViewSTEP::Display::SOLID) {
+            ICanvas::VertexRef vref;
+            if (en.m_imported->faces_lod)
+                vref = m_ca.add_face_group(
+                        std::shared_ptr<const face::FacesLOD>(en.m_imported, en.m_imported->faces_lod.get()),
+                        en.m_origin, en.m_normal, ICanvas::FaceColor::AS_IS);
+            else
+                vref = m_ca.add_face_group(
+                        std::shared_ptr<const face::Faces>(en.m_imported, &en.m_imported->result.faces),
+                        en.m_origin, en.m_normal, ICanvas::FaceColor::AS_IS);
+            m_ca.add_selectable(vref, SelectableRef{SelectableRef::Type::ENTITY, en.m_uuid, 0});
+        }
         if (en.m_show_points) {
             unsigned int idx = EntitySTEP::s_imported_point_offset;
             for (auto &pt : en.m_imported->result.points) {
@@ -420,6 +473,10 @@ void Renderer::visit(const EntityDocument &en)
     auto doc = m_doc_prv.get_idocument_info_by_path(path);
     if (doc) {
         Renderer renderer{m_ca, m_doc_prv};
+        // the document's contents depend on where it's placed
+        const auto revision = m_doc->get_group_revision(en.m_group);
+        renderer.m_chunk_salt = hash_uuids("e0b7f7a4-5e6c-4d0a-8a8e-0f5c3b2d9a71", {m_chunk_salt, en.m_uuid},
+                                           {reinterpret_cast<const uint8_t *>(&revision), sizeof(revision)});
         SelectableRef sr{SelectableRef::Type::ENTITY, en.m_uuid, 0};
         renderer.render(doc->get_document(), doc->get_document().get_groups_sorted().back()->m_uuid, FakeDocumentView{},
                         doc->get_dirname(), sr);
@@ -6,6 +6,7 @@
 #include "document/entity/entity_visitor.hpp"
 #include "document/constraint/constraint_visitor.hpp"
 #include "canvas/icanvas.hpp"
+#include "workspace/entity_view.hpp"
 #include <optional>
 #include <filesystem>
 
@@ -34,6 +35,11 @@ public:
 
 private:
     void render(const Entity &en);
+    // for the group's entities, none if they can't be retained by the canvas
+    std::optional<UUID> get_chunk_key(const Group &group, const std::optional<SelectableRef> &sr) const;
+    // distinguishes documents rendered as part of an EntityDocument
+    UUID m_chunk_salt;
+    EntityViewSTEP::Display get_step_display(const EntitySTEP &en) const;
     void visit(const EntityLine3D &en) override;
     void visit(const EntityLine2D &en) override;
     void visit(const EntityArc2D &en) override;
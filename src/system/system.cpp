@@ -24,7 +24,7 @@
 #include <set>
 #include <iostream>
 
-Sketch SolveSpace::SK = {};
+thread_local Sketch *SolveSpace::currentSketch = nullptr;
 
 void SolveSpace::Platform::FatalError(const std::string &message)
 {
@@ -40,51 +40,116 @@ void Group::GenerateEquations(IdList<Equation, hEquation> *)
 namespace dune3d {
 
 
-static std::mutex s_sys_mutex;
+System::MakeCurrent::MakeCurrent(System &sys)
+    : m_sketch_before(SolveSpace::currentSketch), m_arena_before(Platform::SetTemporaryArena(sys.m_arena.get()))
+{
+    SolveSpace::currentSketch = sys.m_sketch.get();
+}
+
+System::MakeCurrent::~MakeCurrent()
+{
+    SolveSpace::currentSketch = m_sketch_before;
+    Platform::SetTemporaryArena(m_arena_before);
+}
 
 System::System(Document &doc, const UUID &grp, const UUID &constraint_exclude)
-    : m_sys(std::make_unique<SolveSpace::System>()), m_doc(doc), m_solve_group(grp), m_lock(s_sys_mutex)
+    : m_sketch(std::make_unique<Sketch>()), m_arena(std::make_unique<Platform::TemporaryArena>()),
+      m_sys(std::make_unique<SolveSpace::System>()), m_doc(doc), m_solve_group(grp)
+{
+    const MakeCurrent current{*this};
+    pre_solve();
+
+    const auto &solve_group = m_doc.get_group(m_solve_group);
+    // groups can only reference entities from groups before them
+    for (const auto group : m_doc.get_groups_sorted()) {
+        if (group->get_index() > solve_group.get_index())
+            break;
+        for (const auto &uu : m_doc.get_group_entities(group->m_uuid)) {
+            m_doc.m_entities.at(uu)->accept(*this);
+        }
+    }
+    for (const auto &uu : m_doc.get_group_constraints(m_solve_group)) {
+        if (uu == constraint_exclude)
+            continue;
+        const auto first_handle = n_constraint;
+        m_doc.m_constraints.at(uu)->accept(*this);
+        for (auto c = first_handle; c < n_constraint; c++) {
+            m_constraint_handles.emplace(c, uu);
+        }
+    }
+    switch (solve_group.get_type()) {
+    case Group::Type::EXTRUDE:
+        add(dynamic_cast<const GroupExtrude &>(solve_group));
+        break;
+    case Group::Type::LATHE:
+        add(dynamic_cast<const GroupLathe &>(solve_group));
+        break;
+    case Group::Type::REVOLVE:
+        add(dynamic_cast<const GroupRevolve &>(solve_group));
+        break;
+    case Group::Type::LINEAR_ARRAY:
+        add(dynamic_cast<const GroupLinearArray &>(solve_group));
+        break;
+    case Group::Type::POLAR_ARRAY:
+        add(dynamic_cast<const GroupPolarArray &>(solve_group));
+        break;
+    default:;
+    }
+
+    for (const auto &param : m_sys->param) {
+        m_initial_params.push_back(param);
+    }
+    // the first solve substitutes parameters in the equations in place, so
+    // keep pristine copies to start each further solve from
+    for (auto eq : m_sys->eq) {
+        eq.e = eq.e->DeepCopy();
+        m_initial_equations.push_back(eq);
+    }
+    m_initial_mark = std::make_unique<Platform::TemporaryMark>(Platform::GetTemporaryMark());
+}
+
+void System::pre_solve()
 {
-    for (auto &[uu, constraint] : m_doc.m_constraints) {
-        if (constraint->m_group == m_solve_group)
-            if (auto ps = dynamic_cast<const IConstraintPreSolve *>(constraint.get()))
-                ps->pre_solve(m_doc);
+    for (const auto &uu : m_doc.get_group_constraints(m_solve_group)) {
+        if (auto ps = dynamic_cast<const IConstraintPreSolve *>(m_doc.m_constraints.at(uu).get()))
+            ps->pre_solve(m_doc);
     }
-    if (auto ps = dynamic_cast<const IGroupPreSolve *>(&doc.get_group(m_solve_group))) {
+    if (auto ps = dynamic_cast<const IGroupPreSolve *>(&m_doc.get_group(m_solve_group))) {
         ps->pre_solve(m_doc);
     }
+}
+
+void System::update_from_document()
+{
+    const MakeCurrent current{*this};
+    pre_solve();
+
+    // expressions created by the last solve are no longer referenced
+    Platform::FreeTemporaryAfter(*m_initial_mark);
 
-    for (const auto &[uu, entity] : m_doc.m_entities) {
-        entity->accept(*this);
+    // entities of earlier groups are known parameters, but may have been moved
+    // as well, e.g. when dragging an extruded point moves its source point
+    for (const auto &[idx, param_ref] : m_param_refs) {
+        if (param_ref.type == ParamRef::Type::ENTITY)
+            SK.GetParam({idx})->val = m_doc.m_entities.at(param_ref.item)->get_param(param_ref.point, param_ref.axis);
     }
-    for (const auto &[uu, constraint] : m_doc.m_constraints) {
-        if (constraint->m_group != m_solve_group)
-            continue;
-        if (uu == constraint_exclude)
-            continue;
-        constraint->accept(*this);
+
+    m_sys->param.Clear();
+    for (auto param : m_initial_params) {
+        // group parameters keep the result of the last solve as update_document
+        // has already written them to the document
+        auto sk_param = SK.GetParam(param.h);
+        sk_param->known = false;
+        param.val = sk_param->val;
+        m_sys->param.Add(&param);
     }
-    for (const auto &[uu, group] : m_doc.get_groups()) {
-        if (uu != m_solve_group)
-            continue;
-        switch (group->get_type()) {
-        case Group::Type::EXTRUDE:
-            add(dynamic_cast<const GroupExtrude &>(*group));
-            break;
-        case Group::Type::LATHE:
-            add(dynamic_cast<const GroupLathe &>(*group));
-            break;
-        case Group::Type::REVOLVE:
-            add(dynamic_cast<const GroupRevolve &>(*group));
-            break;
-        case Group::Type::LINEAR_ARRAY:
-            add(dynamic_cast<const GroupLinearArray &>(*group));
-            break;
-        case Group::Type::POLAR_ARRAY:
-            add(dynamic_cast<const GroupPolarArray &>(*group));
-            break;
-        default:;
-        }
+
+    // the solver rewrites equations in place, so copy the pristine ones
+    // rather than handing them out
+    m_sys->eq.Clear();
+    for (auto eq : m_initial_equations) {
+        eq.e = eq.e->DeepCopy();
+        m_sys->eq.Add(&eq);
     }
 }
 
@@ -534,9 +599,8 @@ void System::add(const GroupExtrude &group)
             AddEq(hg, &m_sys->eq, exp2.z->Minus(exp1.z->Plus(direction.z)), eqi++);
         }
 
-        for (const auto &[uu, it] : m_doc.m_entities) {
-            if (it->m_group != group.m_source_group)
-                continue;
+        for (const auto &uu : m_doc.get_group_entities(group.m_source_group)) {
+            const auto &it = m_doc.m_entities.at(uu);
             if (it->m_construction)
                 continue;
             if (it->get_type() == Entity::Type::LINE_2D) {
@@ -680,9 +744,8 @@ void System::add(const GroupLathe &group)
     unsigned int eqi = 0;
     const auto hg = hGroup{(uint32_t)group.get_index() + 1};
 
-    for (const auto &[uu, en] : m_doc.m_entities) {
-        if (en->m_group != m_solve_group)
-            continue;
+    for (const auto &uu : m_doc.get_group_entities(m_solve_group)) {
+        const auto &en = m_doc.m_entities.at(uu);
         if (en->m_kind != ItemKind::GENRERATED)
             continue;
         if (en->get_type() != Entity::Type::CIRCLE_3D)
@@ -758,9 +821,8 @@ void System::add(const GroupRevolve &group)
         auto quat = quat_from_axis_angle(ExprVector::From(axv.x, axv.y, axv.z), angle);
 
 
-        for (const auto &[uu, it] : m_doc.m_entities) {
-            if (it->m_group != group.m_source_group)
-                continue;
+        for (const auto &uu : m_doc.get_group_entities(group.m_source_group)) {
+            const auto &it = m_doc.m_entities.at(uu);
             if (it->m_construction)
                 continue;
             if (it->get_type() == Entity::Type::LINE_2D) {
@@ -876,9 +938,8 @@ void System::add_array(const GroupArray &group, CreateEq create_eq2, CreateEq cr
 {
     auto hg = hGroup{(uint32_t)group.get_index() + 1};
 
-    for (const auto &[uu, it] : m_doc.m_entities) {
-        if (it->m_group != group.m_source_group)
-            continue;
+    for (const auto &uu : m_doc.get_group_entities(group.m_source_group)) {
+        const auto &it = m_doc.m_entities.at(uu);
         if (it->m_construction)
             continue;
         for (unsigned int instance = 0; instance < group.m_count; instance++) {
@@ -1175,6 +1236,7 @@ void System::add(const GroupPolarArray &group)
 
 void System::update_document()
 {
+    const MakeCurrent current{*this};
     for (const auto &[idx, param_ref] : m_param_refs) {
         const auto val = SK.GetParam({idx})->val;
         switch (param_ref.type) {
@@ -1260,6 +1322,7 @@ void System::update_document()
 
 void System::add_dragged(const UUID &entity, unsigned int point)
 {
+    const MakeCurrent current{*this};
     std::set<unsigned int> params;
     const auto entity_type = m_doc.m_entities.at(entity)->get_type();
     switch (entity_type) {
@@ -1307,6 +1370,7 @@ void System::add_dragged(const UUID &entity, unsigned int point)
 
 System::SolveResultWithDof System::solve(std::set<EntityAndPoint> *free_points)
 {
+    const MakeCurrent current{*this};
     auto &gr = m_doc.get_group(m_solve_group);
     if (gr.get_type() == Group::Type::REFERENCE)
         return {SolveResult::OKAY, 0};
@@ -1353,6 +1417,28 @@ System::SolveResultWithDof System::solve(std::set<EntityAndPoint> *free_points)
     return {SolveResult::OKAY, 0};
 }
 
+std::set<UUID> System::find_redundant_constraints()
+{
+    const MakeCurrent current{*this};
+    auto &gr = m_doc.get_group(m_solve_group);
+    if (gr.get_type() == Group::Type::REFERENCE)
+        return {};
+
+    ::Group g = {};
+    g.h.v = gr.get_index() + 1;
+
+    List<hConstraint> bad = {};
+    m_sys->FindRedundantConstraints(&g, &bad);
+
+    std::set<UUID> r;
+    for (const auto &hc : bad) {
+        if (auto it = m_constraint_handles.find(hc.v); it != m_constraint_handles.end())
+            r.insert(it->second);
+    }
+    bad.Clear();
+
+    return r;
+}
 
 uint32_t System::add_param(const UUID &group_uu, double value)
 {
@@ -1974,11 +2060,10 @@ int System::get_group_index(const Entity &en) const
 
 System::~System()
 {
-    SK.param.Clear();
-    SK.entity.Clear();
-    SK.constraint.Clear();
+    m_sketch->param.Clear();
+    m_sketch->entity.Clear();
+    m_sketch->constraint.Clear();
     m_sys->Clear();
-    FreeAllTemporary();
 }
 
 } // namespace dune3d
@@ -1,7 +1,6 @@
 #pragma once
 #include <memory>
 #include <map>
-#include <mutex>
 #include <functional>
 #include "util/uuid.hpp"
 #include "document/constraint/all_constraints_fwd.hpp"
@@ -12,12 +11,20 @@
 #include "document/entity/entity_and_point.hpp"
 #include "solve_result.hpp"
 #include <set>
+#include <vector>
 
 
 namespace SolveSpace {
 class System;
 class ExprVector;
 class ExprQuaternion;
+class Param;
+class Equation;
+class Sketch;
+namespace Platform {
+struct TemporaryMark;
+struct TemporaryArena;
+}
 } // namespace SolveSpace
 
 namespace dune3d {
@@ -36,6 +43,15 @@ public:
 
     void update_document();
 
+    // Constraints that make the system solvable without redundancy when removed on their own.
+    // Use this instead of solve since it modifies the system's equations.
+    std::set<UUID> find_redundant_constraints();
+
+    // Makes an already solved system ready for solving again after parameter values
+    // in the document changed, such as while dragging. The document's structure,
+    // i.e. its entities, constraints and groups, must not have changed.
+    void update_from_document();
+
     void add_dragged(const UUID &entity, unsigned int point);
 
     ~System();
@@ -55,6 +71,8 @@ private:
     std::map<EntityRef, unsigned int> m_entity_refs_r;
 
     std::map<unsigned int, UUID> m_constraint_refs;
+    // SolveSpace constraint handle to the constraint it got created from
+    std::map<unsigned int, UUID> m_constraint_handles;
 
     unsigned int get_entity_ref(const EntityRef &ref);
 
@@ -108,10 +126,33 @@ private:
                                          const SolveSpace::ExprQuaternion &exnew, unsigned int instance)>;
     void add_array(const GroupArray &group, CreateEq create_eq2, CreateEq create_eq3, CreateEqN create_eq_n,
                    unsigned int &eqi);
+    void pre_solve();
+
+    // SolveSpace works on whatever sketch and temporary arena are current on the
+    // calling thread, so each system has its own ones that get made current in
+    // all of its public methods
+    std::unique_ptr<SolveSpace::Sketch> m_sketch;
+    std::unique_ptr<SolveSpace::Platform::TemporaryArena> m_arena;
+
+    class MakeCurrent {
+    public:
+        MakeCurrent(System &sys);
+        ~MakeCurrent();
+
+    private:
+        SolveSpace::Sketch *m_sketch_before;
+        SolveSpace::Platform::TemporaryArena *m_arena_before;
+    };
+
     std::unique_ptr<SolveSpace::System> m_sys;
+
+    // state of m_sys before the first solve, restored by update_from_document
+    std::vector<SolveSpace::Param> m_initial_params;
+    std::vector<SolveSpace::Equation> m_initial_equations;
+    std::unique_ptr<SolveSpace::Platform::TemporaryMark> m_initial_mark;
+
     Document &m_doc;
     const UUID m_solve_group;
-    std::lock_guard<std::mutex> m_lock;
 
     unsigned int n_constraint = 1;
 
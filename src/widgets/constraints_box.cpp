@@ -40,7 +40,7 @@ ConstraintsBox::ConstraintsBox(Core &core) : Gtk::Box(Gtk::Orientation::VERTICAL
                         auto sel = m_selection_model->get_selected_item();
                         auto it = std::dynamic_pointer_cast<ConstraintItem>(sel);
                         if (it) {
-                            m_core.get_current_document().m_constraints.erase(it->m_uuid);
+                            m_core.get_current_document().erase_constraint(it->m_uuid);
                             m_core.get_current_document().set_group_solve_pending(m_core.get_current_group());
                             m_core.set_needs_save();
                             m_core.rebuild("delete constraint");